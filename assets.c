@@ -0,0 +1,89 @@
+#include "assets.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+// Larger than any GPU takes, and small enough that a level fits in an int
+#define PACK_IMAGE_MAX_SIZE 16384
+
+uint64_t PackImageSize(int width, int height, int format, int mipmaps) {
+  if (width < 1 || height < 1 || width > PACK_IMAGE_MAX_SIZE ||
+      height > PACK_IMAGE_MAX_SIZE || mipmaps < 1) {
+    return 0;
+  }
+
+  // Each level halves down to 1x1, raylib's layout of a mip chain
+  uint64_t size = 0;
+  for (int level = 0; level < mipmaps; level++) {
+    int levelSize = GetPixelDataSize(width, height, format);
+    if (levelSize <= 0) {
+      return 0;
+    }
+    size += (uint64_t)levelSize;
+    // More levels than the chain has
+    if (width == 1 && height == 1 && level + 1 < mipmaps) {
+      return 0;
+    }
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+  }
+  return size;
+}
+
+bool PackImage(const Pack *pack, const char *name, Image *image) {
+  assert(pack != NULL);
+  assert(image != NULL);
+
+  const PackEntry *entry = PackFind(pack, name, PACK_IMAGE);
+  if (entry == NULL) {
+    return false;
+  }
+  // The params come from the file, so a bad one must not read past the entry
+  uint64_t size = PackImageSize((int)entry->params[0], (int)entry->params[1],
+                                (int)entry->params[2], (int)entry->params[3]);
+  if (size == 0 || size != entry->size) {
+    TraceLog(LOG_ERROR, "Asset pack image %s does not match its size", name);
+    return false;
+  }
+
+  *image = (Image){.data = (void *)PackData(pack, entry),
+                   .width = (int)entry->params[0],
+                   .height = (int)entry->params[1],
+                   .format = (int)entry->params[2],
+                   .mipmaps = (int)entry->params[3]};
+  return true;
+}
+
+bool PackWave(const Pack *pack, const char *name, Wave *wave) {
+  assert(pack != NULL);
+  assert(wave != NULL);
+
+  const PackEntry *entry = PackFind(pack, name, PACK_WAVE);
+  if (entry == NULL) {
+    return false;
+  }
+  uint32_t sampleSize = entry->params[2];
+  uint32_t channels = entry->params[3];
+  if ((sampleSize != 8 && sampleSize != 16 && sampleSize != 32) ||
+      channels < 1 || channels > 8 ||
+      (uint64_t)entry->params[0] * channels * sampleSize / 8 != entry->size) {
+    TraceLog(LOG_ERROR, "Asset pack wave %s does not match its size", name);
+    return false;
+  }
+
+  *wave = (Wave){.frameCount = entry->params[0],
+                 .sampleRate = entry->params[1],
+                 .sampleSize = entry->params[2],
+                 .channels = entry->params[3],
+                 .data = (void *)PackData(pack, entry)};
+  return true;
+}
+
+Texture2D LoadPackTexture(const Pack *pack, const char *name) {
+  Image image;
+  if (!PackImage(pack, name, &image)) {
+    TraceLog(LOG_ERROR, "Asset pack has no image %s", name);
+    return (Texture2D){0};
+  }
+  return LoadTextureFromImage(image);
+}
@@ -0,0 +1,23 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+// raylib views of asset pack entries. The returned images and waves point
+// into the mapped pack, they stay valid until PackClose() and must not be
+// unloaded.
+
+#include "pack.h"
+#include "raylib.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bytes of an image with its mip chain, 0 if the params make no image
+uint64_t PackImageSize(int width, int height, int format, int mipmaps);
+
+bool PackImage(const Pack *pack, const char *name, Image *image);
+bool PackWave(const Pack *pack, const char *name, Wave *wave);
+
+// Uploads an image entry, returns an invalid texture if it is missing
+Texture2D LoadPackTexture(const Pack *pack, const char *name);
+
+#endif
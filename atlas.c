@@ -0,0 +1,259 @@
+#include "atlas.h"
+#include "assets.h"
+#include "dxt.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *spriteNames[SPRITE_COUNT] = {
+    [SPRITE_DIGIT_0] = "0",
+    [SPRITE_DIGIT_1] = "1",
+    [SPRITE_DIGIT_2] = "2",
+    [SPRITE_DIGIT_3] = "3",
+    [SPRITE_DIGIT_4] = "4",
+    [SPRITE_DIGIT_5] = "5",
+    [SPRITE_DIGIT_6] = "6",
+    [SPRITE_DIGIT_7] = "7",
+    [SPRITE_DIGIT_8] = "8",
+    [SPRITE_DIGIT_9] = "9",
+    [SPRITE_BACKGROUND_DAY] = "background-day",
+    [SPRITE_BACKGROUND_NIGHT] = "background-night",
+    [SPRITE_BASE] = "base",
+    [SPRITE_BLUEBIRD_UPFLAP] = "bluebird-upflap",
+    [SPRITE_BLUEBIRD_MIDFLAP] = "bluebird-midflap",
+    [SPRITE_BLUEBIRD_DOWNFLAP] = "bluebird-downflap",
+    [SPRITE_REDBIRD_UPFLAP] = "redbird-upflap",
+    [SPRITE_REDBIRD_MIDFLAP] = "redbird-midflap",
+    [SPRITE_REDBIRD_DOWNFLAP] = "redbird-downflap",
+    [SPRITE_YELLOWBIRD_UPFLAP] = "yellowbird-upflap",
+    [SPRITE_YELLOWBIRD_MIDFLAP] = "yellowbird-midflap",
+    [SPRITE_YELLOWBIRD_DOWNFLAP] = "yellowbird-downflap",
+    [SPRITE_GAMEOVER] = "gameover",
+    [SPRITE_MESSAGE] = "message",
+    [SPRITE_PIPE_GREEN] = "pipe-green",
+    [SPRITE_PIPE_RED] = "pipe-red",
+};
+
+const char *AtlasSpriteName(Sprite sprite) {
+  assert(sprite >= 0 && sprite < SPRITE_COUNT);
+  return spriteNames[sprite];
+}
+
+int AtlasFind(const char *name) {
+  assert(name != NULL);
+
+  for (int i = 0; i < SPRITE_COUNT; i++) {
+    if (strcmp(spriteNames[i], name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static Image *sortImages; // qsort has no user pointer
+
+static int CompareHeight(const void *a, const void *b) {
+  int ia = *(const int *)a;
+  int ib = *(const int *)b;
+  if (sortImages[ia].height != sortImages[ib].height) {
+    return sortImages[ib].height - sortImages[ia].height;
+  }
+  return ia - ib;
+}
+
+static int Align(int value) {
+  return (value + ATLAS_ALIGN - 1) / ATLAS_ALIGN * ATLAS_ALIGN;
+}
+
+// Shelf packing, tallest first. Returns the height used or -1 if a sprite
+// is wider than the atlas. Sprites the atlas does not hold get empty rects.
+static int ShelfPack(Image *images, Rectangle *rects) {
+  int order[SPRITE_COUNT];
+  int count = 0;
+  for (int i = 0; i < SPRITE_COUNT; i++) {
+    rects[i] = (Rectangle){0};
+    if (AtlasHolds(i)) {
+      order[count++] = i;
+    }
+  }
+  sortImages = images;
+  qsort(order, count, sizeof(order[0]), CompareHeight);
+
+  // Each sprite starts aligned at least ATLAS_PADDING past its neighbours
+  int x = ATLAS_ALIGN;
+  int y = ATLAS_ALIGN;
+  int shelfHeight = 0;
+  for (int i = 0; i < count; i++) {
+    const Image *image = &images[order[i]];
+    int width = Align(image->width + ATLAS_PADDING);
+    int height = Align(image->height + ATLAS_PADDING);
+    if (ATLAS_ALIGN + width > ATLAS_WIDTH) {
+      return -1;
+    }
+
+    if (x + width > ATLAS_WIDTH) {
+      x = ATLAS_ALIGN;
+      y += shelfHeight;
+      shelfHeight = 0;
+    }
+
+    rects[order[i]] = (Rectangle){x, y, image->width, image->height};
+    x += width;
+    shelfHeight = height > shelfHeight ? height : shelfHeight;
+  }
+  return y + shelfHeight;
+}
+
+static void UnloadImages(Image *images) {
+  for (int i = 0; i < SPRITE_COUNT; i++) {
+    UnloadImage(images[i]);
+  }
+}
+
+bool PackAtlasImages(Image *images, Rectangle *rects, Image *packed) {
+  assert(images != NULL);
+  assert(rects != NULL);
+  assert(packed != NULL);
+
+  int height = ShelfPack(images, rects);
+  if (height < 0) {
+    TraceLog(LOG_ERROR, "Sprites do not fit a %d pixel wide atlas",
+             ATLAS_WIDTH);
+    UnloadImages(images);
+    return false;
+  }
+
+  // Rounded up to a power of two for older GPUs
+  int atlasHeight = 1;
+  while (atlasHeight < height) {
+    atlasHeight *= 2;
+  }
+
+  *packed = GenImageColor(ATLAS_WIDTH, atlasHeight, BLANK);
+  unsigned char *pixels = packed->data;
+  for (int i = 0; i < SPRITE_COUNT; i++) {
+    if (!AtlasHolds(i)) {
+      continue;
+    }
+    assert(images[i].format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    const unsigned char *source = images[i].data;
+    Rectangle rect = rects[i];
+    for (int y = 0; y < images[i].height; y++) {
+      memcpy(pixels + (((size_t)rect.y + y) * ATLAS_WIDTH + (size_t)rect.x) * 4,
+             source + (size_t)y * images[i].width * 4,
+             (size_t)images[i].width * 4);
+    }
+  }
+  UnloadImages(images);
+
+  TraceLog(LOG_INFO, "Packed the sprites into a %dx%d atlas", ATLAS_WIDTH,
+           atlasHeight);
+  return true;
+}
+
+bool LoadSpriteImages(const char *directory, Image *images) {
+  assert(directory != NULL);
+  assert(images != NULL);
+
+  memset(images, 0, sizeof(Image) * SPRITE_COUNT);
+  for (int i = 0; i < SPRITE_COUNT; i++) {
+    images[i] = LoadImage(TextFormat("%s/%s.png", directory, spriteNames[i]));
+    if (!IsImageValid(images[i])) {
+      TraceLog(LOG_ERROR, "Failed to load sprite %s", spriteNames[i]);
+      UnloadImages(images);
+      return false;
+    }
+    ImageFormat(&images[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+  }
+  return true;
+}
+
+bool LoadAtlasFromImages(Atlas *atlas, Image *images, Image *image) {
+  assert(atlas != NULL);
+
+  Image packed;
+  if (!PackAtlasImages(images, atlas->rects, &packed)) {
+    return false;
+  }
+
+  atlas->texture = LoadTextureFromImage(packed);
+  if (!IsTextureValid(atlas->texture)) {
+    TraceLog(LOG_ERROR, "Failed to upload the sprite atlas");
+    UnloadImage(packed);
+    return false;
+  }
+
+  if (image != NULL) {
+    *image = packed;
+  } else {
+    UnloadImage(packed);
+  }
+  return true;
+}
+
+bool LoadAtlasFromPack(Atlas *atlas, const Pack *pack, Image *image) {
+  assert(atlas != NULL);
+  assert(pack != NULL);
+
+  Image packed;
+  const PackEntry *rects = PackFind(pack, ATLAS_RECTS_ENTRY, PACK_DATA);
+  if (!PackImage(pack, ATLAS_IMAGE_ENTRY, &packed) || rects == NULL ||
+      rects->size != sizeof(atlas->rects)) {
+    TraceLog(LOG_ERROR, "Asset pack has no usable sprite atlas");
+    return false;
+  }
+  memcpy(atlas->rects, PackData(pack, rects), sizeof(atlas->rects));
+
+  // Uploads straight from the mapped pages. rlgl checks the GPU takes S3TC
+  // before it uploads DXT1 and returns no texture if it does not, then the
+  // blocks are decoded and go up as RGBA8 like an unpacked atlas.
+  bool compressed = packed.format == PIXELFORMAT_COMPRESSED_DXT1_RGBA;
+  Image decoded = {0};
+  atlas->texture = LoadTextureFromImage(packed);
+  if (!IsTextureValid(atlas->texture) && compressed) {
+    TraceLog(LOG_WARNING, "No S3TC support, uploading the atlas as RGBA8");
+    decoded = GenImageColor(packed.width, packed.height, BLANK);
+    DxtDecompress(packed.data, packed.width, packed.height, decoded.data);
+    atlas->texture = LoadTextureFromImage(decoded);
+  }
+  if (!IsTextureValid(atlas->texture)) {
+    TraceLog(LOG_ERROR, "Failed to upload the sprite atlas");
+    UnloadImage(decoded);
+    return false;
+  }
+
+  // Only the collision masks read pixels, and only opaque or not
+  if (image != NULL) {
+    if (decoded.data != NULL) {
+      *image = decoded;
+      return true;
+    }
+    if (compressed) {
+      *image = GenImageColor(packed.width, packed.height, BLANK);
+      DxtDecompress(packed.data, packed.width, packed.height, image->data);
+    } else {
+      *image = ImageCopy(packed);
+      ImageFormat(image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+  }
+  UnloadImage(decoded);
+  return true;
+}
+
+void UnloadAtlas(Atlas *atlas) {
+  assert(atlas != NULL);
+  UnloadTexture(atlas->texture);
+}
+
+const unsigned char *AtlasPixels(const Atlas *atlas, Image image,
+                                 Sprite sprite) {
+  assert(atlas != NULL);
+  assert(image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+  Rectangle rect = atlas->rects[sprite];
+  return (const unsigned char *)image.data +
+         ((size_t)rect.y * image.width + (size_t)rect.x) * 4;
+}
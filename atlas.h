@@ -0,0 +1,89 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+// Every sprite in assets/sprites packed into one texture, so drawing any mix
+// of them does not break raylib's draw batch. The bird frames are the
+// exception, they are palette indexed in skins.h instead.
+
+#include "pack.h"
+#include "raylib.h"
+
+#include <stdbool.h>
+
+typedef enum {
+  SPRITE_DIGIT_0,
+  SPRITE_DIGIT_1,
+  SPRITE_DIGIT_2,
+  SPRITE_DIGIT_3,
+  SPRITE_DIGIT_4,
+  SPRITE_DIGIT_5,
+  SPRITE_DIGIT_6,
+  SPRITE_DIGIT_7,
+  SPRITE_DIGIT_8,
+  SPRITE_DIGIT_9,
+  SPRITE_BACKGROUND_DAY,
+  SPRITE_BACKGROUND_NIGHT,
+  SPRITE_BASE,
+  SPRITE_BLUEBIRD_UPFLAP,
+  SPRITE_BLUEBIRD_MIDFLAP,
+  SPRITE_BLUEBIRD_DOWNFLAP,
+  SPRITE_REDBIRD_UPFLAP,
+  SPRITE_REDBIRD_MIDFLAP,
+  SPRITE_REDBIRD_DOWNFLAP,
+  SPRITE_YELLOWBIRD_UPFLAP,
+  SPRITE_YELLOWBIRD_MIDFLAP,
+  SPRITE_YELLOWBIRD_DOWNFLAP,
+  SPRITE_GAMEOVER,
+  SPRITE_MESSAGE,
+  SPRITE_PIPE_GREEN,
+  SPRITE_PIPE_RED,
+  SPRITE_COUNT
+} Sprite;
+
+// Empty pixels around every sprite so filtering never samples a neighbour
+#define ATLAS_PADDING 1
+#define ATLAS_WIDTH 1024
+// Sprites start on 4x4 block boundaries, so no compressed block of the
+// packed atlas mixes the colors of two sprites
+#define ATLAS_ALIGN 4
+
+// False for the bird frames, which BirdSkins draws
+static inline bool AtlasHolds(Sprite sprite) {
+  return sprite < SPRITE_BLUEBIRD_UPFLAP || sprite > SPRITE_YELLOWBIRD_DOWNFLAP;
+}
+
+typedef struct {
+  Texture2D texture;
+  Rectangle rects[SPRITE_COUNT]; // Source rectangle of every sprite
+} Atlas;
+
+// Packs and uploads already decoded RGBA8 sprites, indexed by Sprite. The
+// images are unloaded either way. When image is not NULL it receives the
+// packed pixels as RGBA8, the caller unloads it.
+bool LoadAtlasFromImages(Atlas *atlas, Image *images, Image *image);
+// Same, from the pre-packed atlas in an asset pack, which may be compressed.
+// image receives an RGBA8 copy, decoded if need be, the caller unloads it.
+bool LoadAtlasFromPack(Atlas *atlas, const Pack *pack, Image *image);
+void UnloadAtlas(Atlas *atlas);
+
+// CPU side of LoadAtlasFromImages(). packed is RGBA8 and owned by the caller.
+bool PackAtlasImages(Image *images, Rectangle *rects, Image *packed);
+// Decodes every sprite in directory one after another as RGBA8, indexed by
+// Sprite, for the packer. Nothing is left to unload on failure.
+bool LoadSpriteImages(const char *directory, Image *images);
+
+// Pack entries written by the packer
+#define ATLAS_IMAGE_ENTRY "atlas"
+#define ATLAS_RECTS_ENTRY "atlas-rects"
+
+// First pixel of a sprite in the image from LoadAtlas(), rows are
+// image.width pixels apart
+const unsigned char *AtlasPixels(const Atlas *atlas, Image image,
+                                 Sprite sprite);
+
+// File name of the sprite without the extension, e.g. "pipe-green"
+const char *AtlasSpriteName(Sprite sprite);
+// Sprite with that name, or -1
+int AtlasFind(const char *name);
+
+#endif
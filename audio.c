@@ -0,0 +1,106 @@
+#include "audio.h"
+#include "assets.h"
+#include "sim.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+static const char *soundNames[SOUND_COUNT] = {
+    [SOUND_DIE] = "die",       [SOUND_HIT] = "hit",
+    [SOUND_POINT] = "point",   [SOUND_SWOOSH] = "swoosh",
+    [SOUND_WING] = "wing",
+};
+
+const char *AudioSoundName(SoundEffect effect) {
+  assert(effect >= 0 && effect < SOUND_COUNT);
+
+  return soundNames[effect];
+}
+
+// Aliases share the samples of [0], so they have to go first
+static void UnloadLoadedSounds(Audio *audio, int count) {
+  for (int i = 0; i < count; i++) {
+    for (int v = 1; v < AUDIO_VOICES; v++) {
+      UnloadSoundAlias(audio->sounds[i][v]);
+    }
+    UnloadSound(audio->sounds[i][0]);
+  }
+}
+
+bool LoadAudioFromWaves(Audio *audio, const Wave *waves) {
+  assert(audio != NULL);
+  assert(waves != NULL);
+
+  *audio = (Audio){.ready = false};
+  if (!IsAudioDeviceReady()) {
+    return false;
+  }
+
+  for (int i = 0; i < SOUND_COUNT; i++) {
+    Sound sound = LoadSoundFromWave(waves[i]);
+    if (!IsSoundValid(sound)) {
+      TraceLog(LOG_ERROR, "Failed to load sound %s", soundNames[i]);
+      UnloadLoadedSounds(audio, i);
+      return false;
+    }
+    audio->sounds[i][0] = sound;
+    for (int v = 1; v < AUDIO_VOICES; v++) {
+      audio->sounds[i][v] = LoadSoundAlias(sound);
+    }
+  }
+  audio->ready = true;
+  return true;
+}
+
+bool LoadAudioFromPack(Audio *audio, const Pack *pack) {
+  assert(audio != NULL);
+  assert(pack != NULL);
+
+  // Views into the mapping, LoadSoundFromWave() copies out of them
+  Wave waves[SOUND_COUNT];
+  for (int i = 0; i < SOUND_COUNT; i++) {
+    if (!PackWave(pack, soundNames[i], &waves[i])) {
+      TraceLog(LOG_ERROR, "Sound %s is missing from the pack",
+               soundNames[i]);
+      *audio = (Audio){.ready = false};
+      return false;
+    }
+  }
+  return LoadAudioFromWaves(audio, waves);
+}
+
+void UnloadAudio(Audio *audio) {
+  assert(audio != NULL);
+
+  if (audio->ready) {
+    UnloadLoadedSounds(audio, SOUND_COUNT);
+    audio->ready = false;
+  }
+}
+
+void PlayEffect(Audio *audio, SoundEffect effect) {
+  assert(audio != NULL);
+  assert(effect >= 0 && effect < SOUND_COUNT);
+
+  if (!audio->ready) {
+    return;
+  }
+  PlaySound(audio->sounds[effect][audio->next[effect]]);
+  audio->next[effect] = (audio->next[effect] + 1) % AUDIO_VOICES;
+}
+
+void PlaySimEvents(Audio *audio, uint32_t events) {
+  if (events & SIM_EVENT_START) {
+    PlayEffect(audio, SOUND_SWOOSH);
+  }
+  if (events & SIM_EVENT_JUMP) {
+    PlayEffect(audio, SOUND_WING);
+  }
+  if (events & SIM_EVENT_SCORE) {
+    PlayEffect(audio, SOUND_POINT);
+  }
+  if (events & SIM_EVENT_DEATH) {
+    PlayEffect(audio, SOUND_HIT);
+    PlayEffect(audio, SOUND_DIE);
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+// Sound effects. Every effect is decoded to PCM at load and copied into the
+// mixer, nothing is decoded or read while playing. Each effect has a few
+// aliases sharing its samples, triggers rotate through them so quick
+// repeats overlap instead of cutting the previous one off. Playing only
+// flags a voice for the mixer thread and never waits on it.
+
+#include "pack.h"
+#include "raylib.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+  SOUND_DIE,
+  SOUND_HIT,
+  SOUND_POINT,
+  SOUND_SWOOSH,
+  SOUND_WING,
+  SOUND_COUNT
+} SoundEffect;
+
+// Voices per effect, a flap every few frames needs about this many
+#define AUDIO_VOICES 4
+
+typedef struct {
+  Sound sounds[SOUND_COUNT][AUDIO_VOICES]; // [0] owns the samples
+  int next[SOUND_COUNT];
+  bool ready; // false without an audio device, playing is then a no-op
+} Audio;
+
+// File name of the effect without the extension, e.g. "wing"
+const char *AudioSoundName(SoundEffect effect);
+
+// From waves indexed by SoundEffect, which stay owned by the caller.
+// Returns false if an effect cannot be created, audio then stays off.
+bool LoadAudioFromWaves(Audio *audio, const Wave *waves);
+// Same, from the PCM entries of an asset pack
+bool LoadAudioFromPack(Audio *audio, const Pack *pack);
+void UnloadAudio(Audio *audio);
+
+void PlayEffect(Audio *audio, SoundEffect effect);
+
+// Plays what SimState.events reports, see sim.h
+void PlaySimEvents(Audio *audio, uint32_t events);
+
+#endif
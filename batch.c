@@ -0,0 +1,842 @@
+#include "batch.h"
+#include "collision.h"
+#include "sim.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BATCH_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#define BATCH_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BATCH_NEON
+#endif
+
+// Same limits as SimStepBird(), every bird in a batch has the same radius
+#define BATCH_FLOOR SIM_VALUE(BASE_POS_Y - BIRD_RADIUS * SCALE)
+#define BATCH_CEILING SIM_VALUE(BIRD_RADIUS * SCALE)
+
+// Keep every array 32 byte aligned so no load straddles a cache line
+static size_t Stride(int count) {
+  return ((size_t)count * sizeof(SimValue) + 31) & ~(size_t)31;
+}
+
+bool BatchInit(BatchWorld *world, int count, uint64_t seed) {
+  assert(world != NULL);
+  assert(count > 0);
+
+  size_t stride = Stride(count);
+  unsigned char *block = aligned_alloc(32, stride * 5);
+  if (block == NULL) {
+    return false;
+  }
+
+  *world = (BatchWorld){.count = count,
+                        .seed = seed,
+                        .y = (SimValue *)block,
+                        .previousY = (SimValue *)(block + stride),
+                        .velocityY = (SimValue *)(block + stride * 2),
+                        .alive = (uint32_t *)(block + stride * 3),
+                        .score = (uint32_t *)(block + stride * 4)};
+  BatchReset(world);
+  return true;
+}
+
+void BatchFree(BatchWorld *world) {
+  assert(world != NULL);
+
+  free(world->y);
+  *world = (BatchWorld){0};
+}
+
+void BatchRespawn(BatchWorld *world, int index) {
+  assert(world != NULL);
+  assert(index >= 0 && index < world->count);
+
+  world->y[index] = SIM_VALUE(BIRD_START_Y);
+  world->previousY[index] = SIM_VALUE(BIRD_START_Y);
+  world->velocityY[index] = 0;
+  world->alive[index] = ~0u;
+  world->score[index] = 0;
+}
+
+void BatchReset(BatchWorld *world) {
+  assert(world != NULL);
+
+  for (int i = 0; i < world->count; i++) {
+    BatchRespawn(world, i);
+  }
+  PipeRingInit(&world->pipes, world->seed);
+  world->tick = 0;
+}
+
+#ifdef SIM_FIXED_POINT
+
+// One bird, used for the scalar build and for the tail of the SIMD loops
+static void StepOne(BatchWorld *world, int i, bool jump) {
+  SimValue y = world->y[i];
+  world->previousY[i] = y;
+  if (!world->alive[i]) {
+    return;
+  }
+
+  SimValue velocityY = jump ? SIM_VALUE(JUMP_VELOCITY) : world->velocityY[i];
+  velocityY += SIM_VALUE(GRAVITY / SIM_HZ);
+  velocityY = velocityY < SIM_VALUE(FALL_VELOCITY_MIN)
+                  ? SIM_VALUE(FALL_VELOCITY_MIN)
+                  : velocityY;
+  velocityY = velocityY > SIM_VALUE(FALL_VELOCITY_MAX)
+                  ? SIM_VALUE(FALL_VELOCITY_MAX)
+                  : velocityY;
+
+  y += (velocityY * SIM_FIXED_DT) >> SIM_FIXED_DT_BITS;
+
+  velocityY -= (velocityY * SIM_FIXED_DRAG) >> SIM_FIXED_DRAG_BITS;
+
+  if (y > BATCH_FLOOR) {
+    y = BATCH_FLOOR;
+    velocityY = 0;
+  }
+
+  if (y < BATCH_CEILING) {
+    y = BATCH_CEILING;
+    velocityY = 0;
+  }
+
+  world->y[i] = y;
+  world->velocityY[i] = velocityY;
+}
+
+#else
+
+// One bird, used for the scalar build and for the tail of the SIMD loops
+static void StepOne(BatchWorld *world, int i, bool jump) {
+  float y = world->y[i];
+  world->previousY[i] = y;
+  if (!world->alive[i]) {
+    return;
+  }
+
+  float velocityY = jump ? JUMP_VELOCITY : world->velocityY[i];
+  velocityY += GRAVITY * SIM_DT;
+  velocityY = velocityY < FALL_VELOCITY_MIN ? FALL_VELOCITY_MIN : velocityY;
+  velocityY = velocityY > FALL_VELOCITY_MAX ? FALL_VELOCITY_MAX : velocityY;
+
+  y += velocityY * SIM_DT;
+
+  velocityY *= VELOCITY_DAMPING;
+
+  if (y > BATCH_FLOOR) {
+    y = BATCH_FLOOR;
+    velocityY = 0;
+  }
+
+  if (y < BATCH_CEILING) {
+    y = BATCH_CEILING;
+    velocityY = 0;
+  }
+
+  world->y[i] = y;
+  world->velocityY[i] = velocityY;
+}
+
+#endif
+
+#if defined(BATCH_AVX2) && defined(SIM_FIXED_POINT)
+
+static int StepWide(BatchWorld *world, const uint8_t *jump) {
+  const __m256i jumpVelocity = _mm256_set1_epi32(SIM_VALUE(JUMP_VELOCITY));
+  const __m256i gravity = _mm256_set1_epi32(SIM_VALUE(GRAVITY / SIM_HZ));
+  const __m256i minVelocity = _mm256_set1_epi32(SIM_VALUE(FALL_VELOCITY_MIN));
+  const __m256i maxVelocity = _mm256_set1_epi32(SIM_VALUE(FALL_VELOCITY_MAX));
+  const __m256i dt = _mm256_set1_epi32(SIM_FIXED_DT);
+  const __m256i drag = _mm256_set1_epi32(SIM_FIXED_DRAG);
+  const __m256i floor = _mm256_set1_epi32(BATCH_FLOOR);
+  const __m256i ceiling = _mm256_set1_epi32(BATCH_CEILING);
+
+  int i = 0;
+  for (; i + 8 <= world->count; i += 8) {
+    __m256i y = _mm256_load_si256((const __m256i *)(world->y + i));
+    __m256i velocityY =
+        _mm256_load_si256((const __m256i *)(world->velocityY + i));
+    __m256i alive = _mm256_load_si256((const __m256i *)(world->alive + i));
+
+    int64_t jumpBytes;
+    memcpy(&jumpBytes, jump + i, sizeof(jumpBytes));
+    __m256i jumpInts = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(jumpBytes));
+    __m256i jumpMask = _mm256_cmpgt_epi32(jumpInts, _mm256_setzero_si256());
+
+    _mm256_store_si256((__m256i *)(world->previousY + i), y);
+
+    __m256i v = _mm256_blendv_epi8(velocityY, jumpVelocity, jumpMask);
+    v = _mm256_add_epi32(v, gravity);
+    v = _mm256_min_epi32(_mm256_max_epi32(v, minVelocity), maxVelocity);
+    __m256i newY = _mm256_add_epi32(
+        y, _mm256_srai_epi32(_mm256_mullo_epi32(v, dt), SIM_FIXED_DT_BITS));
+    v = _mm256_sub_epi32(v, _mm256_srai_epi32(_mm256_mullo_epi32(v, drag),
+                                              SIM_FIXED_DRAG_BITS));
+
+    __m256i hit = _mm256_or_si256(_mm256_cmpgt_epi32(newY, floor),
+                                  _mm256_cmpgt_epi32(ceiling, newY));
+    newY = _mm256_min_epi32(_mm256_max_epi32(newY, ceiling), floor);
+    v = _mm256_andnot_si256(hit, v);
+
+    _mm256_store_si256((__m256i *)(world->y + i),
+                       _mm256_blendv_epi8(y, newY, alive));
+    _mm256_store_si256((__m256i *)(world->velocityY + i),
+                       _mm256_blendv_epi8(velocityY, v, alive));
+  }
+  return i;
+}
+
+// Kills the birds strictly inside either band, see BatchCollide()
+static int CollideWide(BatchWorld *world, SimValue topLow, SimValue topHigh,
+                       SimValue bottomLow, SimValue bottomHigh) {
+  const __m256i topMin = _mm256_set1_epi32(topLow);
+  const __m256i topMax = _mm256_set1_epi32(topHigh);
+  const __m256i bottomMin = _mm256_set1_epi32(bottomLow);
+  const __m256i bottomMax = _mm256_set1_epi32(bottomHigh);
+
+  int i = 0;
+  for (; i + 8 <= world->count; i += 8) {
+    __m256i y = _mm256_load_si256((const __m256i *)(world->y + i));
+    __m256i alive = _mm256_load_si256((const __m256i *)(world->alive + i));
+
+    __m256i hitTop = _mm256_and_si256(_mm256_cmpgt_epi32(y, topMin),
+                                      _mm256_cmpgt_epi32(topMax, y));
+    __m256i hitBottom = _mm256_and_si256(_mm256_cmpgt_epi32(y, bottomMin),
+                                         _mm256_cmpgt_epi32(bottomMax, y));
+
+    alive = _mm256_andnot_si256(_mm256_or_si256(hitTop, hitBottom), alive);
+    _mm256_store_si256((__m256i *)(world->alive + i), alive);
+  }
+  return i;
+}
+
+#elif defined(BATCH_SSE2) && defined(SIM_FIXED_POINT)
+
+// SSE2 has no 32-bit integer blend, min, max or low multiply, SSE4.1 does
+// (make SIMD_FLAGS=-msse4.1)
+static inline __m128i SelectInts(__m128i mask, __m128i a, __m128i b) {
+  // b where mask is set, a elsewhere
+#ifdef __SSE4_1__
+  return _mm_blendv_epi8(a, b, mask);
+#else
+  return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+#endif
+}
+
+static inline __m128i MinInts(__m128i a, __m128i b) {
+#ifdef __SSE4_1__
+  return _mm_min_epi32(a, b);
+#else
+  return SelectInts(_mm_cmpgt_epi32(a, b), a, b);
+#endif
+}
+
+static inline __m128i MaxInts(__m128i a, __m128i b) {
+#ifdef __SSE4_1__
+  return _mm_max_epi32(a, b);
+#else
+  return SelectInts(_mm_cmplt_epi32(a, b), a, b);
+#endif
+}
+
+// Low 32 bits of every product, the same signed or not. _mm_mul_epu32()
+// multiplies the even lanes only, so the odd ones go through a shift.
+static inline __m128i MulInts(__m128i a, __m128i b) {
+#ifdef __SSE4_1__
+  return _mm_mullo_epi32(a, b);
+#else
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+static int StepWide(BatchWorld *world, const uint8_t *jump) {
+  const __m128i jumpVelocity = _mm_set1_epi32(SIM_VALUE(JUMP_VELOCITY));
+  const __m128i gravity = _mm_set1_epi32(SIM_VALUE(GRAVITY / SIM_HZ));
+  const __m128i minVelocity = _mm_set1_epi32(SIM_VALUE(FALL_VELOCITY_MIN));
+  const __m128i maxVelocity = _mm_set1_epi32(SIM_VALUE(FALL_VELOCITY_MAX));
+  const __m128i dt = _mm_set1_epi32(SIM_FIXED_DT);
+  const __m128i drag = _mm_set1_epi32(SIM_FIXED_DRAG);
+  const __m128i floor = _mm_set1_epi32(BATCH_FLOOR);
+  const __m128i ceiling = _mm_set1_epi32(BATCH_CEILING);
+  const __m128i zeroInts = _mm_setzero_si128();
+
+  int i = 0;
+  for (; i + 4 <= world->count; i += 4) {
+    __m128i y = _mm_load_si128((const __m128i *)(world->y + i));
+    __m128i velocityY = _mm_load_si128((const __m128i *)(world->velocityY + i));
+    __m128i alive = _mm_load_si128((const __m128i *)(world->alive + i));
+
+    int32_t jumpBytes;
+    memcpy(&jumpBytes, jump + i, sizeof(jumpBytes));
+    __m128i jumpInts = _mm_unpacklo_epi16(
+        _mm_unpacklo_epi8(_mm_cvtsi32_si128(jumpBytes), zeroInts), zeroInts);
+    __m128i jumpMask = _mm_cmpgt_epi32(jumpInts, zeroInts);
+
+    _mm_store_si128((__m128i *)(world->previousY + i), y);
+
+    __m128i v = SelectInts(jumpMask, velocityY, jumpVelocity);
+    v = _mm_add_epi32(v, gravity);
+    v = MinInts(MaxInts(v, minVelocity), maxVelocity);
+    __m128i newY =
+        _mm_add_epi32(y, _mm_srai_epi32(MulInts(v, dt), SIM_FIXED_DT_BITS));
+    v = _mm_sub_epi32(v, _mm_srai_epi32(MulInts(v, drag), SIM_FIXED_DRAG_BITS));
+
+    // The clamp reuses the compares, only one of them can hold
+    __m128i belowFloor = _mm_cmpgt_epi32(newY, floor);
+    __m128i aboveCeiling = _mm_cmplt_epi32(newY, ceiling);
+    newY = SelectInts(belowFloor, newY, floor);
+    newY = SelectInts(aboveCeiling, newY, ceiling);
+    v = _mm_andnot_si128(_mm_or_si128(belowFloor, aboveCeiling), v);
+
+    _mm_store_si128((__m128i *)(world->y + i), SelectInts(alive, y, newY));
+    _mm_store_si128((__m128i *)(world->velocityY + i),
+                    SelectInts(alive, velocityY, v));
+  }
+  return i;
+}
+
+// Kills the birds strictly inside either band, see BatchCollide()
+static int CollideWide(BatchWorld *world, SimValue topLow, SimValue topHigh,
+                       SimValue bottomLow, SimValue bottomHigh) {
+  const __m128i topMin = _mm_set1_epi32(topLow);
+  const __m128i topMax = _mm_set1_epi32(topHigh);
+  const __m128i bottomMin = _mm_set1_epi32(bottomLow);
+  const __m128i bottomMax = _mm_set1_epi32(bottomHigh);
+
+  int i = 0;
+  for (; i + 4 <= world->count; i += 4) {
+    __m128i y = _mm_load_si128((const __m128i *)(world->y + i));
+    __m128i alive = _mm_load_si128((const __m128i *)(world->alive + i));
+
+    __m128i hitTop =
+        _mm_and_si128(_mm_cmpgt_epi32(y, topMin), _mm_cmplt_epi32(y, topMax));
+    __m128i hitBottom = _mm_and_si128(_mm_cmpgt_epi32(y, bottomMin),
+                                      _mm_cmplt_epi32(y, bottomMax));
+
+    alive = _mm_andnot_si128(_mm_or_si128(hitTop, hitBottom), alive);
+    _mm_store_si128((__m128i *)(world->alive + i), alive);
+  }
+  return i;
+}
+
+#elif defined(BATCH_NEON) && defined(SIM_FIXED_POINT)
+
+static int StepWide(BatchWorld *world, const uint8_t *jump) {
+  const int32x4_t jumpVelocity = vdupq_n_s32(SIM_VALUE(JUMP_VELOCITY));
+  const int32x4_t gravity = vdupq_n_s32(SIM_VALUE(GRAVITY / SIM_HZ));
+  const int32x4_t minVelocity = vdupq_n_s32(SIM_VALUE(FALL_VELOCITY_MIN));
+  const int32x4_t maxVelocity = vdupq_n_s32(SIM_VALUE(FALL_VELOCITY_MAX));
+  const int32x4_t dt = vdupq_n_s32(SIM_FIXED_DT);
+  const int32x4_t drag = vdupq_n_s32(SIM_FIXED_DRAG);
+  const int32x4_t floor = vdupq_n_s32(BATCH_FLOOR);
+  const int32x4_t ceiling = vdupq_n_s32(BATCH_CEILING);
+  const int32x4_t zero = vdupq_n_s32(0);
+
+  int i = 0;
+  for (; i + 4 <= world->count; i += 4) {
+    int32x4_t y = vld1q_s32(world->y + i);
+    int32x4_t velocityY = vld1q_s32(world->velocityY + i);
+    uint32x4_t alive = vld1q_u32(world->alive + i);
+
+    uint32_t jumpBytes;
+    memcpy(&jumpBytes, jump + i, sizeof(jumpBytes));
+    uint32x4_t jumpInts = vmovl_u16(
+        vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(jumpBytes)))));
+    uint32x4_t jumpMask = vcgtq_u32(jumpInts, vdupq_n_u32(0));
+
+    vst1q_s32(world->previousY + i, y);
+
+    int32x4_t v = vbslq_s32(jumpMask, jumpVelocity, velocityY);
+    v = vaddq_s32(v, gravity);
+    v = vminq_s32(vmaxq_s32(v, minVelocity), maxVelocity);
+    int32x4_t newY =
+        vaddq_s32(y, vshrq_n_s32(vmulq_s32(v, dt), SIM_FIXED_DT_BITS));
+    v = vsubq_s32(v, vshrq_n_s32(vmulq_s32(v, drag), SIM_FIXED_DRAG_BITS));
+
+    uint32x4_t hit =
+        vorrq_u32(vcgtq_s32(newY, floor), vcltq_s32(newY, ceiling));
+    newY = vminq_s32(vmaxq_s32(newY, ceiling), floor);
+    v = vbslq_s32(hit, zero, v);
+
+    vst1q_s32(world->y + i, vbslq_s32(alive, newY, y));
+    vst1q_s32(world->velocityY + i, vbslq_s32(alive, v, velocityY));
+  }
+  return i;
+}
+
+// Kills the birds strictly inside either band, see BatchCollide()
+static int CollideWide(BatchWorld *world, SimValue topLow, SimValue topHigh,
+                       SimValue bottomLow, SimValue bottomHigh) {
+  const int32x4_t topMin = vdupq_n_s32(topLow);
+  const int32x4_t topMax = vdupq_n_s32(topHigh);
+  const int32x4_t bottomMin = vdupq_n_s32(bottomLow);
+  const int32x4_t bottomMax = vdupq_n_s32(bottomHigh);
+
+  int i = 0;
+  for (; i + 4 <= world->count; i += 4) {
+    int32x4_t y = vld1q_s32(world->y + i);
+    uint32x4_t alive = vld1q_u32(world->alive + i);
+
+    uint32x4_t hitTop = vandq_u32(vcgtq_s32(y, topMin), vcltq_s32(y, topMax));
+    uint32x4_t hitBottom =
+        vandq_u32(vcgtq_s32(y, bottomMin), vcltq_s32(y, bottomMax));
+
+    alive = vbicq_u32(alive, vorrq_u32(hitTop, hitBottom));
+    vst1q_u32(world->alive + i, alive);
+  }
+  return i;
+}
+
+#elif defined(BATCH_AVX2)
+
+static int StepWide(BatchWorld *world, const uint8_t *jump) {
+  const __m256 jumpVelocity = _mm256_set1_ps(JUMP_VELOCITY);
+  const __m256 gravity = _mm256_set1_ps(GRAVITY * SIM_DT);
+  const __m256 minVelocity = _mm256_set1_ps(FALL_VELOCITY_MIN);
+  const __m256 maxVelocity = _mm256_set1_ps(FALL_VELOCITY_MAX);
+  const __m256 dt = _mm256_set1_ps(SIM_DT);
+  const __m256 damping = _mm256_set1_ps(VELOCITY_DAMPING);
+  const __m256 floor = _mm256_set1_ps(BATCH_FLOOR);
+  const __m256 ceiling = _mm256_set1_ps(BATCH_CEILING);
+  const __m256 zero = _mm256_setzero_ps();
+
+  int i = 0;
+  for (; i + 8 <= world->count; i += 8) {
+    __m256 y = _mm256_load_ps(world->y + i);
+    __m256 velocityY = _mm256_load_ps(world->velocityY + i);
+    __m256 alive = _mm256_load_ps((const float *)(world->alive + i));
+
+    int64_t jumpBytes;
+    memcpy(&jumpBytes, jump + i, sizeof(jumpBytes));
+    __m256i jumpInts = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(jumpBytes));
+    __m256 jumpMask = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(jumpInts, _mm256_setzero_si256()));
+
+    _mm256_store_ps(world->previousY + i, y);
+
+    __m256 v = _mm256_blendv_ps(velocityY, jumpVelocity, jumpMask);
+    v = _mm256_add_ps(v, gravity);
+    v = _mm256_min_ps(_mm256_max_ps(v, minVelocity), maxVelocity);
+    __m256 newY = _mm256_add_ps(y, _mm256_mul_ps(v, dt));
+    v = _mm256_mul_ps(v, damping);
+
+    __m256 hit = _mm256_or_ps(_mm256_cmp_ps(newY, floor, _CMP_GT_OQ),
+                              _mm256_cmp_ps(newY, ceiling, _CMP_LT_OQ));
+    newY = _mm256_min_ps(_mm256_max_ps(newY, ceiling), floor);
+    v = _mm256_blendv_ps(v, zero, hit);
+
+    _mm256_store_ps(world->y + i, _mm256_blendv_ps(y, newY, alive));
+    _mm256_store_ps(world->velocityY + i,
+                    _mm256_blendv_ps(velocityY, v, alive));
+  }
+  return i;
+}
+
+// Kills the birds whose circle touches either rectangle of the pipe. dx2 is
+// the squared horizontal distance to the pipe, the same for every bird.
+static int CollideWide(BatchWorld *world, float dx2, float topTop,
+                       float topBottom, float bottomTop, float bottomBottom) {
+  const __m256 distance = _mm256_set1_ps(dx2);
+  const __m256 radius2 =
+      _mm256_set1_ps(BIRD_RADIUS * SCALE * (BIRD_RADIUS * SCALE));
+  const __m256 topMin = _mm256_set1_ps(topTop);
+  const __m256 topMax = _mm256_set1_ps(topBottom);
+  const __m256 bottomMin = _mm256_set1_ps(bottomTop);
+  const __m256 bottomMax = _mm256_set1_ps(bottomBottom);
+
+  int i = 0;
+  for (; i + 8 <= world->count; i += 8) {
+    __m256 y = _mm256_load_ps(world->y + i);
+    __m256 alive = _mm256_load_ps((const float *)(world->alive + i));
+
+    __m256 dyTop =
+        _mm256_sub_ps(y, _mm256_min_ps(_mm256_max_ps(y, topMin), topMax));
+    __m256 dyBottom = _mm256_sub_ps(
+        y, _mm256_min_ps(_mm256_max_ps(y, bottomMin), bottomMax));
+    __m256 hitTop = _mm256_cmp_ps(
+        _mm256_add_ps(distance, _mm256_mul_ps(dyTop, dyTop)), radius2,
+        _CMP_LT_OQ);
+    __m256 hitBottom = _mm256_cmp_ps(
+        _mm256_add_ps(distance, _mm256_mul_ps(dyBottom, dyBottom)), radius2,
+        _CMP_LT_OQ);
+
+    alive = _mm256_andnot_ps(_mm256_or_ps(hitTop, hitBottom), alive);
+    _mm256_store_ps((float *)(world->alive + i), alive);
+  }
+  return i;
+}
+
+#elif defined(BATCH_SSE2)
+
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+  // b where mask is set, a elsewhere
+  return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+}
+
+static int StepWide(BatchWorld *world, const uint8_t *jump) {
+  const __m128 jumpVelocity = _mm_set1_ps(JUMP_VELOCITY);
+  const __m128 gravity = _mm_set1_ps(GRAVITY * SIM_DT);
+  const __m128 minVelocity = _mm_set1_ps(FALL_VELOCITY_MIN);
+  const __m128 maxVelocity = _mm_set1_ps(FALL_VELOCITY_MAX);
+  const __m128 dt = _mm_set1_ps(SIM_DT);
+  const __m128 damping = _mm_set1_ps(VELOCITY_DAMPING);
+  const __m128 floor = _mm_set1_ps(BATCH_FLOOR);
+  const __m128 ceiling = _mm_set1_ps(BATCH_CEILING);
+  const __m128i zeroInts = _mm_setzero_si128();
+
+  int i = 0;
+  for (; i + 4 <= world->count; i += 4) {
+    __m128 y = _mm_load_ps(world->y + i);
+    __m128 velocityY = _mm_load_ps(world->velocityY + i);
+    __m128 alive = _mm_load_ps((const float *)(world->alive + i));
+
+    int32_t jumpBytes;
+    memcpy(&jumpBytes, jump + i, sizeof(jumpBytes));
+    __m128i jumpInts = _mm_unpacklo_epi16(
+        _mm_unpacklo_epi8(_mm_cvtsi32_si128(jumpBytes), zeroInts), zeroInts);
+    __m128 jumpMask = _mm_castsi128_ps(_mm_cmpgt_epi32(jumpInts, zeroInts));
+
+    _mm_store_ps(world->previousY + i, y);
+
+    __m128 v = Select(jumpMask, velocityY, jumpVelocity);
+    v = _mm_add_ps(v, gravity);
+    v = _mm_min_ps(_mm_max_ps(v, minVelocity), maxVelocity);
+    __m128 newY = _mm_add_ps(y, _mm_mul_ps(v, dt));
+    v = _mm_mul_ps(v, damping);
+
+    __m128 hit =
+        _mm_or_ps(_mm_cmpgt_ps(newY, floor), _mm_cmplt_ps(newY, ceiling));
+    newY = _mm_min_ps(_mm_max_ps(newY, ceiling), floor);
+    v = _mm_andnot_ps(hit, v);
+
+    _mm_store_ps(world->y + i, Select(alive, y, newY));
+    _mm_store_ps(world->velocityY + i, Select(alive, velocityY, v));
+  }
+  return i;
+}
+
+// Kills the birds whose circle touches either rectangle of the pipe. dx2 is
+// the squared horizontal distance to the pipe, the same for every bird.
+static int CollideWide(BatchWorld *world, float dx2, float topTop,
+                       float topBottom, float bottomTop, float bottomBottom) {
+  const __m128 distance = _mm_set1_ps(dx2);
+  const __m128 radius2 =
+      _mm_set1_ps(BIRD_RADIUS * SCALE * (BIRD_RADIUS * SCALE));
+  const __m128 topMin = _mm_set1_ps(topTop);
+  const __m128 topMax = _mm_set1_ps(topBottom);
+  const __m128 bottomMin = _mm_set1_ps(bottomTop);
+  const __m128 bottomMax = _mm_set1_ps(bottomBottom);
+
+  int i = 0;
+  for (; i + 4 <= world->count; i += 4) {
+    __m128 y = _mm_load_ps(world->y + i);
+    __m128 alive = _mm_load_ps((const float *)(world->alive + i));
+
+    __m128 dyTop = _mm_sub_ps(y, _mm_min_ps(_mm_max_ps(y, topMin), topMax));
+    __m128 dyBottom =
+        _mm_sub_ps(y, _mm_min_ps(_mm_max_ps(y, bottomMin), bottomMax));
+    __m128 hitTop = _mm_cmplt_ps(
+        _mm_add_ps(distance, _mm_mul_ps(dyTop, dyTop)), radius2);
+    __m128 hitBottom = _mm_cmplt_ps(
+        _mm_add_ps(distance, _mm_mul_ps(dyBottom, dyBottom)), radius2);
+
+    alive = _mm_andnot_ps(_mm_or_ps(hitTop, hitBottom), alive);
+    _mm_store_ps((float *)(world->alive + i), alive);
+  }
+  return i;
+}
+
+#elif defined(BATCH_NEON)
+
+static int StepWide(BatchWorld *world, const uint8_t *jump) {
+  const float32x4_t jumpVelocity = vdupq_n_f32(JUMP_VELOCITY);
+  const float32x4_t gravity = vdupq_n_f32(GRAVITY * SIM_DT);
+  const float32x4_t minVelocity = vdupq_n_f32(FALL_VELOCITY_MIN);
+  const float32x4_t maxVelocity = vdupq_n_f32(FALL_VELOCITY_MAX);
+  const float32x4_t dt = vdupq_n_f32(SIM_DT);
+  const float32x4_t damping = vdupq_n_f32(VELOCITY_DAMPING);
+  const float32x4_t floor = vdupq_n_f32(BATCH_FLOOR);
+  const float32x4_t ceiling = vdupq_n_f32(BATCH_CEILING);
+  const float32x4_t zero = vdupq_n_f32(0);
+
+  int i = 0;
+  for (; i + 4 <= world->count; i += 4) {
+    float32x4_t y = vld1q_f32(world->y + i);
+    float32x4_t velocityY = vld1q_f32(world->velocityY + i);
+    uint32x4_t alive = vld1q_u32(world->alive + i);
+
+    uint32_t jumpBytes;
+    memcpy(&jumpBytes, jump + i, sizeof(jumpBytes));
+    uint32x4_t jumpInts = vmovl_u16(
+        vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(jumpBytes)))));
+    uint32x4_t jumpMask = vcgtq_u32(jumpInts, vdupq_n_u32(0));
+
+    vst1q_f32(world->previousY + i, y);
+
+    float32x4_t v = vbslq_f32(jumpMask, jumpVelocity, velocityY);
+    v = vaddq_f32(v, gravity);
+    v = vminq_f32(vmaxq_f32(v, minVelocity), maxVelocity);
+    // Separate multiply and add, a fused vmla would round differently from
+    // the scalar path
+    float32x4_t newY = vaddq_f32(y, vmulq_f32(v, dt));
+    v = vmulq_f32(v, damping);
+
+    uint32x4_t hit = vorrq_u32(vcgtq_f32(newY, floor), vcltq_f32(newY, ceiling));
+    newY = vminq_f32(vmaxq_f32(newY, ceiling), floor);
+    v = vbslq_f32(hit, zero, v);
+
+    vst1q_f32(world->y + i, vbslq_f32(alive, newY, y));
+    vst1q_f32(world->velocityY + i, vbslq_f32(alive, v, velocityY));
+  }
+  return i;
+}
+
+// Kills the birds whose circle touches either rectangle of the pipe. dx2 is
+// the squared horizontal distance to the pipe, the same for every bird.
+static int CollideWide(BatchWorld *world, float dx2, float topTop,
+                       float topBottom, float bottomTop, float bottomBottom) {
+  const float32x4_t distance = vdupq_n_f32(dx2);
+  const float32x4_t radius2 =
+      vdupq_n_f32(BIRD_RADIUS * SCALE * (BIRD_RADIUS * SCALE));
+  const float32x4_t topMin = vdupq_n_f32(topTop);
+  const float32x4_t topMax = vdupq_n_f32(topBottom);
+  const float32x4_t bottomMin = vdupq_n_f32(bottomTop);
+  const float32x4_t bottomMax = vdupq_n_f32(bottomBottom);
+
+  int i = 0;
+  for (; i + 4 <= world->count; i += 4) {
+    float32x4_t y = vld1q_f32(world->y + i);
+    uint32x4_t alive = vld1q_u32(world->alive + i);
+
+    float32x4_t dyTop = vsubq_f32(y, vminq_f32(vmaxq_f32(y, topMin), topMax));
+    float32x4_t dyBottom =
+        vsubq_f32(y, vminq_f32(vmaxq_f32(y, bottomMin), bottomMax));
+    uint32x4_t hitTop =
+        vcltq_f32(vaddq_f32(distance, vmulq_f32(dyTop, dyTop)), radius2);
+    uint32x4_t hitBottom =
+        vcltq_f32(vaddq_f32(distance, vmulq_f32(dyBottom, dyBottom)), radius2);
+
+    alive = vbicq_u32(alive, vorrq_u32(hitTop, hitBottom));
+    vst1q_u32(world->alive + i, alive);
+  }
+  return i;
+}
+
+#else
+
+static int StepWide(BatchWorld *world, const uint8_t *jump) {
+  (void)world;
+  (void)jump;
+  return 0;
+}
+
+#ifdef SIM_FIXED_POINT
+
+static int CollideWide(BatchWorld *world, SimValue topLow, SimValue topHigh,
+                       SimValue bottomLow, SimValue bottomHigh) {
+  (void)world;
+  (void)topLow;
+  (void)topHigh;
+  (void)bottomLow;
+  (void)bottomHigh;
+  return 0;
+}
+
+#else
+
+static int CollideWide(BatchWorld *world, float dx2, float topTop,
+                       float topBottom, float bottomTop, float bottomBottom) {
+  (void)world;
+  (void)dx2;
+  (void)topTop;
+  (void)topBottom;
+  (void)bottomTop;
+  (void)bottomBottom;
+  return 0;
+}
+
+#endif
+
+#endif
+
+#ifdef SIM_FIXED_POINT
+
+// Largest root with root * root <= value
+static int64_t FloorSqrt(int64_t value) {
+  uint64_t rest = (uint64_t)value;
+  uint64_t root = 0;
+  uint64_t bit = 1ull << 62;
+  while (bit > rest) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (rest >= root + bit) {
+      rest -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (int64_t)root;
+}
+
+// Same test as CircleHitsPipe(). dx is the same for every bird, so a
+// rectangle [top, bottom] is hit when |y - clamp(y, top, bottom)| <= reach,
+// the largest reach with dx^2 + reach^2 < radius^2: a bird hits it when y
+// is strictly inside (top - reach - 1, bottom + reach + 1).
+static void BatchCollide(BatchWorld *world) {
+  const float radius = BIRD_RADIUS * SCALE;
+  const Pipe *near[COLLISION_MAX_PIPES];
+  int count = PipeRingOverlapping(&world->pipes, BIRD_START_X - radius,
+                                  BIRD_START_X + radius, near);
+
+  const int64_t x = SIM_VALUE(BIRD_START_X);
+  const int64_t r = SIM_VALUE(BIRD_RADIUS * SCALE);
+  for (int n = 0; n < count; n++) {
+    const Pipe *pipe = near[n];
+    int64_t left = SimFromFloat(pipe->x);
+    int64_t right = SimFromFloat(pipe->x + PIPE_WIDTH);
+    int64_t dx = x < left ? left - x : x > right ? x - right : 0;
+    if (dx >= r) {
+      continue;
+    }
+    SimValue reach = (SimValue)FloorSqrt(r * r - dx * dx - 1);
+    SimValue gapTop = SimFromFloat(PipeGapTop(pipe));
+    SimValue gapBottom = SimFromFloat(PipeGapBottom(pipe));
+    SimValue topLow = gapTop - SIM_VALUE(PIPE_HEIGHT) - reach - 1;
+    SimValue topHigh = gapTop + reach + 1;
+    SimValue bottomLow = gapBottom - reach - 1;
+    SimValue bottomHigh = gapBottom + SIM_VALUE(PIPE_HEIGHT) + reach + 1;
+
+    int i = CollideWide(world, topLow, topHigh, bottomLow, bottomHigh);
+    for (; i < world->count; i++) {
+      SimValue y = world->y[i];
+      if ((y > topLow && y < topHigh) || (y > bottomLow && y < bottomHigh)) {
+        world->alive[i] = 0;
+      }
+    }
+  }
+}
+
+#else
+
+// Same tests as SimBirdHitsPipes(), with the shared parts done once
+static void BatchCollide(BatchWorld *world) {
+  const float radius = BIRD_RADIUS * SCALE;
+  const Pipe *near[COLLISION_MAX_PIPES];
+  int count = PipeRingOverlapping(&world->pipes, BIRD_START_X - radius,
+                                  BIRD_START_X + radius, near);
+
+  for (int n = 0; n < count; n++) {
+    const Pipe *pipe = near[n];
+    float closestX = BIRD_START_X < pipe->x ? pipe->x : BIRD_START_X;
+    closestX = closestX > pipe->x + PIPE_WIDTH ? pipe->x + PIPE_WIDTH
+                                               : closestX;
+    float dx = BIRD_START_X - closestX;
+    float gapTop = PipeGapTop(pipe);
+    float gapBottom = PipeGapBottom(pipe);
+
+    int i = CollideWide(world, dx * dx, gapTop - PIPE_HEIGHT, gapTop,
+                        gapBottom, gapBottom + PIPE_HEIGHT);
+    for (; i < world->count; i++) {
+      if (CircleHitsPipe(pipe, BIRD_START_X, world->y[i], radius)) {
+        world->alive[i] = 0;
+      }
+    }
+  }
+}
+
+#endif
+
+void BatchStep(BatchWorld *world, const uint8_t *jump) {
+  assert(world != NULL);
+  assert(jump != NULL);
+
+  int i = StepWide(world, jump);
+  for (; i < world->count; i++) {
+    StepOne(world, i, jump[i] != 0);
+  }
+
+  PipeRingStep(&world->pipes);
+  BatchCollide(world);
+
+  if (PipeRingPassed(&world->pipes, BIRD_START_X)) {
+    for (int j = 0; j < world->count; j++) {
+      world->score[j] += world->alive[j] & 1;
+    }
+  }
+  world->tick++;
+}
+
+int BatchAliveCount(const BatchWorld *world) {
+  assert(world != NULL);
+
+  int alive = 0;
+  for (int i = 0; i < world->count; i++) {
+    alive += world->alive[i] != 0;
+  }
+  return alive;
+}
+
+// Everything in a snapshot ahead of the bird arrays, which are copied as
+// the one block they were allocated in
+typedef struct {
+  uint64_t tick;
+  PipeRing pipes;
+} SnapshotHeader;
+
+size_t BatchSnapshotSize(const BatchWorld *world) {
+  assert(world != NULL);
+
+  return sizeof(SnapshotHeader) + Stride(world->count) * 5;
+}
+
+void BatchSave(const BatchWorld *world, void *snapshot) {
+  assert(world != NULL);
+  assert(snapshot != NULL);
+
+  unsigned char *out = snapshot;
+  SnapshotHeader header = {.tick = world->tick, .pipes = world->pipes};
+  memcpy(out, &header, sizeof(header));
+  memcpy(out + sizeof(header), world->y, Stride(world->count) * 5);
+}
+
+void BatchRestore(BatchWorld *world, const void *snapshot) {
+  assert(world != NULL);
+  assert(snapshot != NULL);
+
+  const unsigned char *in = snapshot;
+  SnapshotHeader header;
+  memcpy(&header, in, sizeof(header));
+  world->tick = header.tick;
+  world->pipes = header.pipes;
+  memcpy(world->y, in + sizeof(header), Stride(world->count) * 5);
+}
+
+const char *BatchKernelName(void) {
+#if defined(BATCH_AVX2)
+  return "avx2";
+#elif defined(BATCH_SSE2)
+  return "sse2";
+#elif defined(BATCH_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,58 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Many birds stepped together. State is kept as one contiguous array per
+// field so the step kernels can run several birds per SIMD instruction.
+// Physics matches SimStepBird() in sim.c and uses the same constants. All
+// birds share one pipe stream and the same x, so the broadphase runs once
+// per tick and only the narrowphase runs per bird.
+
+#include "fixed.h"
+#include "pipes.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+  int count;
+  uint64_t seed;
+  uint64_t tick;
+  PipeRing pipes;
+
+  // All arrays hold count entries and come from one allocation. The bird
+  // fields are SimValues, see fixed.h.
+  SimValue *y;
+  SimValue *previousY;
+  SimValue *velocityY;
+  uint32_t *alive; // ~0u while the bird is alive, 0 once it hit a pipe
+  uint32_t *score; // Pipes passed
+} BatchWorld;
+
+// seed picks the shared pipe layout
+bool BatchInit(BatchWorld *world, int count, uint64_t seed);
+void BatchFree(BatchWorld *world);
+
+// Puts every bird back at the start position, alive, and restarts the pipes
+void BatchReset(BatchWorld *world);
+// Same for one bird, which starts over wherever the shared pipes are now
+void BatchRespawn(BatchWorld *world, int index);
+
+// jump holds count entries, non-zero means that bird flaps this tick.
+// Dead birds keep their last state.
+void BatchStep(BatchWorld *world, const uint8_t *jump);
+
+int BatchAliveCount(const BatchWorld *world);
+
+// Bytes BatchSave() writes: the tick, the pipes and every bird. Saving and
+// restoring is one copy of each, for fork and rewind in search.
+size_t BatchSnapshotSize(const BatchWorld *world);
+void BatchSave(const BatchWorld *world, void *snapshot);
+// snapshot must come from a world with the same count
+void BatchRestore(BatchWorld *world, const void *snapshot);
+
+// Name of the kernel picked at compile time: "avx2", "sse2", "neon" or
+// "scalar"
+const char *BatchKernelName(void);
+
+#endif
@@ -0,0 +1,809 @@
+// Benchmarks for the simulation, collision and rendering. Every result is one
+// tab separated line "name value unit", lines starting with # are context.
+// The names and units are stable so runs from different revisions can be
+// diffed or fed to a script. A golden trajectory check runs first and fails
+// the run when the sim no longer steps the way it did.
+//
+// The rendered suite is only built when raylib is found, see the Makefile.
+
+#include "batch.h"
+#include "collision.h"
+#include "config.h"
+#include "eval.h"
+#include "particle.h"
+#include "pipes.h"
+#include "sim.h"
+
+#ifdef BENCH_RENDER
+#include "atlas.h"
+#include "ghost.h"
+#include "raylib.h"
+#include "render.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Fixed so every run steps the same worlds
+#define BENCH_SEED 12345
+// Random inputs are read from a table, so generating them is not measured
+#define BENCH_TABLE 4096
+// Roughly one flap every 12 ticks keeps birds off the floor
+#define BENCH_JUMP_ODDS 12
+
+// A minute of play for an odd number of birds, so the SIMD loops have tails
+#define BENCH_GOLDEN_BIRDS 37
+#define BENCH_GOLDEN_TICKS (SIM_HZ * 60)
+// Hash of every bird's SimChecksum() at the end. The fixed point one holds
+// on every target, the float one where floats round as IEEE singles with no
+// contraction, which -ffast-math or FMA builds break.
+#ifdef SIM_FIXED_POINT
+#define BENCH_GOLDEN 0x50f58c1bu
+#else
+#define BENCH_GOLDEN 0xca825cf3u
+#endif
+
+// About five hours of play, long enough for the double x of a pipe to lose
+// precision if seeking and stepping rounded differently
+#define BENCH_SEEK_TICKS 2000000
+
+typedef struct {
+  int birds;        // N for the batch suite
+  double seconds;   // Minimum run time of every case
+  int threads;      // For the episode suite, 0 is every core
+  bool render;      // Run the rendered suite
+  int renderBirds;  // Birds on screen
+  int renderPipes;  // Pipes on screen
+  int ghosts;       // Birds in the ghost batch suite
+  bool lowRes;      // Draw the scene through the native resolution target
+  int particles;    // Capacity of the particle pool suite
+  int particleRate; // Particles spawned per 60 Hz frame
+} BenchOptions;
+
+static double Now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static uint64_t NextRandom(uint64_t *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static void FillJumps(uint8_t *jump, int count, uint64_t *rng) {
+  for (int i = 0; i < count; i++) {
+    jump[i] = NextRandom(rng) % BENCH_JUMP_ODDS == 0;
+  }
+}
+
+static void Report(const char *name, double value, const char *unit) {
+  printf("%s\t%.0f\t%s\n", name, value, unit);
+}
+
+// Bird i aims for its own height around the gap, so the birds die at
+// different pipes and some live to the end
+static bool GoldenJump(int i, const SimBird *bird, const PipeRing *pipes) {
+  const Pipe *pipe = PipeRingAhead(pipes, BIRD_START_X - BIRD_RADIUS * SCALE);
+  float offset = (float)((uint32_t)i * 2654435761u % 121) - 60.0f;
+  return SimFloat(bird->y) > pipe->gapY + offset && bird->velocityY > 0;
+}
+
+// Steps the same birds through SimStep() and BatchStep(), which must agree
+// on every tick, and checks where SimStep() ends up against BENCH_GOLDEN
+static void BenchGolden(void) {
+  static SimState states[BENCH_GOLDEN_BIRDS];
+  uint8_t jump[BENCH_GOLDEN_BIRDS];
+  BatchWorld world;
+  if (!BatchInit(&world, BENCH_GOLDEN_BIRDS, BENCH_SEED)) {
+    fprintf(stderr, "Cannot allocate %d birds\n", BENCH_GOLDEN_BIRDS);
+    exit(1);
+  }
+  for (int i = 0; i < BENCH_GOLDEN_BIRDS; i++) {
+    SimInit(&states[i], BENCH_SEED);
+  }
+
+  for (int tick = 0; tick < BENCH_GOLDEN_TICKS; tick++) {
+    for (int i = 0; i < BENCH_GOLDEN_BIRDS; i++) {
+      jump[i] = GoldenJump(i, &states[i].bird, &world.pipes);
+      SimStep(&states[i], (SimInput){.start = true, .jump = jump[i]});
+    }
+    BatchStep(&world, jump);
+
+    for (int i = 0; i < BENCH_GOLDEN_BIRDS; i++) {
+      const SimState *state = &states[i];
+      // A dead SimState stops its pipes, so only the death itself is compared
+      if (state->dead && state->events == 0) {
+        continue;
+      }
+      if (world.y[i] != state->bird.y ||
+          world.velocityY[i] != state->bird.velocityY ||
+          (world.alive[i] != 0) == state->dead ||
+          world.score[i] != state->score) {
+        fprintf(stderr, "golden: bird %d of BatchStep() left SimStep() at "
+                        "tick %d\n", i, tick);
+        exit(1);
+      }
+    }
+  }
+
+  uint32_t hash = 2166136261u;
+  int alive = 0;
+  for (int i = 0; i < BENCH_GOLDEN_BIRDS; i++) {
+    hash = (hash ^ SimChecksum(&states[i])) * 16777619u;
+    alive += !states[i].dead;
+  }
+  printf("# golden sim=%s birds=%d ticks=%d alive=%d checksum=0x%08x\n",
+         SIM_NUMBERS, BENCH_GOLDEN_BIRDS, BENCH_GOLDEN_TICKS, alive,
+         (unsigned)hash);
+  if (hash != BENCH_GOLDEN) {
+    fprintf(stderr, "golden: %s trajectory checksum 0x%08x, expected "
+                    "0x%08x\n", SIM_NUMBERS, (unsigned)hash, BENCH_GOLDEN);
+    exit(1);
+  }
+
+  BatchFree(&world);
+}
+
+// Snapshots halfway through the golden run, the second half is then run
+// twice, from the live state and from the restored one, and must end the
+// same. BatchWorld birds flap from a random table instead of GoldenJump().
+static void BenchSnapshots(void) {
+  enum { HALF = BENCH_GOLDEN_TICKS / 2 };
+  for (int i = 0; i < BENCH_GOLDEN_BIRDS; i++) {
+    SimState state;
+    SimSnapshot snapshot;
+    uint32_t ends[2];
+    SimInit(&state, BENCH_SEED);
+    for (int run = 0; run < 3; run++) {
+      if (run == 1) {
+        SimSave(&state, &snapshot);
+      } else if (run == 2) {
+        SimRestore(&state, &snapshot);
+      }
+      for (int tick = 0; tick < HALF; tick++) {
+        bool jump = GoldenJump(i, &state.bird, &state.pipes);
+        SimStep(&state, (SimInput){.start = true, .jump = jump});
+      }
+      if (run > 0) {
+        ends[run - 1] = SimChecksum(&state);
+      }
+    }
+    if (ends[0] != ends[1]) {
+      fprintf(stderr, "snapshots: bird %d left its run after SimRestore()\n",
+              i);
+      exit(1);
+    }
+  }
+
+  static uint8_t jumps[BENCH_TABLE];
+  uint64_t rng = BENCH_SEED;
+  FillJumps(jumps, BENCH_TABLE, &rng);
+  BatchWorld world;
+  if (!BatchInit(&world, BENCH_GOLDEN_BIRDS, BENCH_SEED)) {
+    fprintf(stderr, "Cannot allocate %d birds\n", BENCH_GOLDEN_BIRDS);
+    exit(1);
+  }
+  size_t size = BatchSnapshotSize(&world);
+  unsigned char *snapshots = malloc(size * 3);
+  if (snapshots == NULL) {
+    fprintf(stderr, "Cannot allocate the batch snapshots\n");
+    exit(1);
+  }
+  // Halfway, then the end of the live run, then the end of the restored one
+  for (int run = 0; run < 3; run++) {
+    if (run == 2) {
+      BatchRestore(&world, snapshots);
+    }
+    for (int tick = 0; tick < HALF; tick++) {
+      BatchStep(&world, jumps + (tick * BENCH_GOLDEN_BIRDS) %
+                                    (BENCH_TABLE - BENCH_GOLDEN_BIRDS));
+    }
+    BatchSave(&world, snapshots + size * (size_t)run);
+  }
+  if (memcmp(snapshots + size, snapshots + size * 2, size) != 0) {
+    fprintf(stderr, "snapshots: BatchWorld left its run after "
+                    "BatchRestore()\n");
+    exit(1);
+  }
+  printf("# snapshots birds=%d ticks=%d restore=live\n", BENCH_GOLDEN_BIRDS,
+         HALF);
+
+  free(snapshots);
+  BatchFree(&world);
+}
+
+// PipeRingSeek() to every tick must land where the PipeRingStep() calls up
+// to it did, and every pipe k must hold PipeGapY(seed, k) however it got
+// there
+static void BenchPipeSeek(void) {
+  PipeRing stepped;
+  PipeRing seeked;
+  PipeRingInit(&stepped, BENCH_SEED);
+  PipeRingInit(&seeked, BENCH_SEED);
+
+  for (uint64_t tick = 1; tick <= BENCH_SEEK_TICKS; tick++) {
+    PipeRingStep(&stepped);
+    PipeRingSeek(&seeked, tick);
+    bool same = stepped.head == seeked.head &&
+                stepped.first == seeked.first &&
+                stepped.ticks == seeked.ticks;
+    for (int i = 0; same && i < PIPE_COUNT; i++) {
+      const Pipe *a = PipeRingGet(&stepped, i);
+      const Pipe *b = PipeRingGet(&seeked, i);
+      same = a->x == b->x && a->gapY == b->gapY &&
+             a->gapY == PipeGapY(BENCH_SEED, stepped.first + (uint64_t)i);
+    }
+    if (!same) {
+      fprintf(stderr, "pipes: PipeRingSeek() left PipeRingStep() at tick "
+                      "%llu\n", (unsigned long long)tick);
+      exit(1);
+    }
+  }
+  printf("# pipes ticks=%d first=%llu seek=step\n", BENCH_SEEK_TICKS,
+         (unsigned long long)stepped.first);
+}
+
+// One bird through SimStep(), restarted whenever it dies
+static void BenchSimSingle(const BenchOptions *options) {
+  static uint8_t jump[BENCH_TABLE];
+  uint64_t rng = BENCH_SEED;
+  FillJumps(jump, BENCH_TABLE, &rng);
+
+  SimState state;
+  SimInit(&state, BENCH_SEED);
+  SimStep(&state, (SimInput){.start = true});
+
+  uint64_t steps = 0;
+  double start = Now();
+  double elapsed;
+  do {
+    for (int i = 0; i < BENCH_TABLE; i++) {
+      SimStep(&state, (SimInput){.jump = jump[i]});
+      if (state.dead) {
+        SimInit(&state, BENCH_SEED);
+        state.started = true;
+      }
+    }
+    steps += BENCH_TABLE;
+    elapsed = Now() - start;
+  } while (elapsed < options->seconds);
+
+  Report("sim.single", steps / elapsed, "steps/s");
+}
+
+// N birds through BatchStep(), the world restarts once half of them died
+static void BenchSimBatch(const BenchOptions *options) {
+  BatchWorld world;
+  if (!BatchInit(&world, options->birds, BENCH_SEED)) {
+    fprintf(stderr, "Cannot allocate %d birds\n", options->birds);
+    exit(1);
+  }
+
+  // Each tick reads count entries at a different offset into the table
+  uint8_t *jump = malloc(options->birds + BENCH_TABLE);
+  if (jump == NULL) {
+    fprintf(stderr, "Cannot allocate %d birds\n", options->birds);
+    exit(1);
+  }
+  uint64_t rng = BENCH_SEED;
+  FillJumps(jump, options->birds + BENCH_TABLE, &rng);
+
+  uint64_t ticks = 0;
+  double start = Now();
+  double elapsed;
+  do {
+    for (int i = 0; i < 256; i++) {
+      BatchStep(&world, jump + (ticks + i) * 7 % BENCH_TABLE);
+    }
+    ticks += 256;
+    if (BatchAliveCount(&world) < world.count / 2) {
+      BatchReset(&world);
+    }
+    elapsed = Now() - start;
+  } while (elapsed < options->seconds);
+
+  char name[64];
+  snprintf(name, sizeof(name), "sim.batch.%d", options->birds);
+  Report(name, ticks * (double)options->birds / elapsed, "birdsteps/s");
+
+  free(jump);
+  BatchFree(&world);
+}
+
+// Points spread over the playfield against a ring that scrolls once per
+// table pass, so the broadphase sees every layout
+static void BenchCollision(const BenchOptions *options) {
+  static float xs[BENCH_TABLE];
+  static float ys[BENCH_TABLE];
+  uint64_t rng = BENCH_SEED;
+  for (int i = 0; i < BENCH_TABLE; i++) {
+    xs[i] = NextRandom(&rng) % SCREEN_WIDTH;
+    ys[i] = NextRandom(&rng) % BASE_POS_Y;
+  }
+
+  PipeRing ring;
+  PipeRingInit(&ring, BENCH_SEED);
+  // Bring the pipes on screen
+  for (int i = 0; i < SCREEN_WIDTH / (BASE_SPEED * SIM_DT); i++) {
+    PipeRingStep(&ring);
+  }
+
+  float radius = BIRD_RADIUS * SCALE;
+  volatile int sink = 0; // Keeps the queries from being optimized out
+
+  uint64_t queries = 0;
+  double start = Now();
+  double elapsed;
+  do {
+    int overlaps = 0;
+    for (int i = 0; i < BENCH_TABLE; i++) {
+      const Pipe *near[COLLISION_MAX_PIPES];
+      overlaps += PipeRingOverlapping(&ring, xs[i] - radius, xs[i] + radius,
+                                      near);
+    }
+    sink += overlaps;
+    PipeRingStep(&ring);
+    queries += BENCH_TABLE;
+    elapsed = Now() - start;
+  } while (elapsed < options->seconds);
+  Report("collision.broadphase", queries / elapsed, "queries/s");
+
+  SimBird bird = {.radius = BIRD_RADIUS};
+  queries = 0;
+  start = Now();
+  do {
+    int hits = 0;
+    for (int i = 0; i < BENCH_TABLE; i++) {
+      bird.x = xs[i];
+      bird.y = SimFromFloat(ys[i]);
+      hits += SimBirdHitsPipes(&bird, &ring, NULL);
+    }
+    sink += hits;
+    PipeRingStep(&ring);
+    queries += BENCH_TABLE;
+    elapsed = Now() - start;
+  } while (elapsed < options->seconds);
+  Report("collision.circle", queries / elapsed, "queries/s");
+}
+
+// Flies at a per-episode height above the gap, so some birds die at the
+// first pipe and some last until the tick limit, like a real generation
+static bool BenchPolicy(void *user, int episode, const SimState *state) {
+  (void)user;
+  const Pipe *pipe = PipeRingAhead(&state->pipes, state->bird.x);
+  float offset = (float)((uint32_t)episode * 2654435761u % 81) - 20.0f;
+  return SimFloat(state->bird.y) > pipe->gapY + offset &&
+         state->bird.velocityY > 0;
+}
+
+// A particle pool at options->particles capacity fed options->particleRate
+// particles per 60 Hz frame, which saturates it unless the rate is low
+static const float benchFrameTime = 1.0f / 60.0f;
+
+static ParticleBurst BenchBurst(const BenchOptions *options) {
+  return (ParticleBurst){.count = options->particleRate,
+                         .speed = 200.0f,
+                         .lift = 100.0f,
+                         .life = 2.0f,
+                         .frames = 1};
+}
+
+static void BenchParticles(const BenchOptions *options) {
+  ParticlePool pool;
+  if (!ParticlesInit(&pool, options->particles, GRAVITY)) {
+    fprintf(stderr, "Cannot allocate %d particles\n", options->particles);
+    exit(1);
+  }
+  ParticleBurst burst = BenchBurst(options);
+
+  uint64_t steps = 0;
+  uint64_t frames = 0;
+  double start = Now();
+  double elapsed;
+  do {
+    for (int i = 0; i < 256; i++) {
+      ParticlesBurst(&pool, &burst, SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
+      steps += (uint64_t)pool.count;
+      ParticlesUpdate(&pool, benchFrameTime);
+    }
+    frames += 256;
+    elapsed = Now() - start;
+  } while (elapsed < options->seconds);
+
+  printf("# particles live=%d dropped=%.1f%%\n", pool.count,
+         100.0 * pool.dropped / ((double)frames * burst.count));
+  char name[64];
+  snprintf(name, sizeof(name), "particles.%d.%d", options->particles,
+           options->particleRate);
+  Report(name, steps / elapsed, "particlesteps/s");
+
+  ParticlesFree(&pool);
+}
+
+// One generation of options->birds episodes on the work-stealing pool
+static void BenchEpisodes(const BenchOptions *options) {
+  static Evaluator eval;
+  EvalResult *results = malloc(sizeof(EvalResult) * options->birds);
+  if (results == NULL || !EvalInit(&eval, options->threads)) {
+    fprintf(stderr, "Cannot set up the episode pool\n");
+    exit(1);
+  }
+
+  // A minute of play per bird at most
+  const uint32_t maxTicks = SIM_HZ * 60;
+  uint64_t ticks = 0;
+  uint64_t episodes = 0;
+  uint64_t steals = 0;
+  double start = Now();
+  double elapsed;
+  do {
+    EvalSummary summary = EvalRun(&eval, options->birds, BENCH_SEED, maxTicks,
+                                  NULL, BenchPolicy, NULL, results);
+    ticks += summary.totalTicks;
+    episodes += summary.episodes;
+    steals += summary.steals;
+    elapsed = Now() - start;
+  } while (elapsed < options->seconds);
+
+  printf("# episodes threads=%d steals=%llu\n", eval.workerCount,
+         (unsigned long long)steals);
+  char name[64];
+  snprintf(name, sizeof(name), "eval.%d", options->birds);
+  Report(name, episodes / elapsed, "episodes/s");
+  snprintf(name, sizeof(name), "eval.%d.steps", options->birds);
+  Report(name, ticks / elapsed, "birdsteps/s");
+
+  EvalFree(&eval);
+  free(results);
+}
+
+#ifdef BENCH_RENDER
+static bool LoadBenchAtlas(Atlas *atlas, BirdSkins *skins) {
+  Pack pack;
+  if (PackOpen(&pack, "./assets.pak")) {
+    bool loaded = LoadSkinsFromPack(skins, &pack, NULL);
+    if (loaded && !LoadAtlasFromPack(atlas, &pack, NULL)) {
+      UnloadSkins(skins);
+      loaded = false;
+    }
+    PackClose(&pack);
+    return loaded;
+  }
+
+  Image images[SPRITE_COUNT];
+  if (!LoadSpriteImages("./assets/sprites", images)) {
+    return false;
+  }
+  if (!LoadSkinsFromImages(skins, images, NULL)) {
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+      UnloadImage(images[i]);
+    }
+    return false;
+  }
+  if (!LoadAtlasFromImages(atlas, images, NULL)) {
+    UnloadSkins(skins);
+    return false;
+  }
+  return true;
+}
+
+// options->ghosts birds of a BatchWorld through the ghost batch, the window
+// from BenchRender() is still open
+static void BenchGhosts(const BenchOptions *options,
+                        const BirdSkins *skins) {
+  BatchWorld world;
+  GhostBatch ghosts;
+  uint8_t *jump = malloc(options->ghosts + BENCH_TABLE);
+  if (jump == NULL || !BatchInit(&world, options->ghosts, BENCH_SEED)) {
+    fprintf(stderr, "Cannot allocate %d ghosts\n", options->ghosts);
+    exit(1);
+  }
+  if (!GhostBatchInit(&ghosts, options->ghosts)) {
+    fprintf(stderr, "Cannot allocate %d ghosts\n", options->ghosts);
+    exit(1);
+  }
+  uint64_t rng = BENCH_SEED;
+  FillJumps(jump, options->ghosts + BENCH_TABLE, &rng);
+  // Spread them over the screen height, BatchStep() pulls them apart anyway
+  for (int i = 0; i < world.count; i++) {
+    world.y[i] = world.previousY[i] =
+        SimFromFloat((float)(NextRandom(&rng) % BASE_POS_Y));
+  }
+
+  uint64_t frames = 0;
+  double begin = 0;
+  double elapsed = 0;
+  while (!WindowShouldClose()) {
+    if (frames == 30) {
+      begin = GetTime();
+    }
+
+    // Always drawing every bird, whether the pipes got them or not
+    BatchStep(&world, jump + world.tick * 7 % BENCH_TABLE);
+    for (int i = 0; i < world.count; i++) {
+      world.alive[i] = ~0u;
+    }
+    GhostBatchFromWorld(&ghosts, &world, 1.0f, 255);
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+    BeginSkins(skins);
+    DrawGhostBatch(&ghosts, skins);
+    EndSkins();
+    EndDrawing();
+
+    frames++;
+    if (frames > 30) {
+      elapsed = GetTime() - begin;
+      if (elapsed >= options->seconds) {
+        break;
+      }
+    }
+  }
+
+  if (elapsed > 0) {
+    char name[64];
+    snprintf(name, sizeof(name), "render.ghosts.%d", world.count);
+    Report(name, (frames - 30) / elapsed, "frames/s");
+  }
+
+  GhostBatchFree(&ghosts);
+  BatchFree(&world);
+  free(jump);
+}
+
+// The particle suite drawn from the atlas, one quad per particle under one
+// bind, the window from BenchRender() is still open
+static void BenchDrawParticles(const BenchOptions *options,
+                               const Atlas *atlas) {
+  ParticlePool pool;
+  if (!ParticlesInit(&pool, options->particles, GRAVITY)) {
+    fprintf(stderr, "Cannot allocate %d particles\n", options->particles);
+    exit(1);
+  }
+  ParticleBurst burst = BenchBurst(options);
+  Rectangle pipe = atlas->rects[SPRITE_PIPE_GREEN];
+  Rectangle frame = {pipe.x + 4, pipe.y + 100, 3, 3};
+
+  uint64_t frames = 0;
+  double begin = 0;
+  double elapsed = 0;
+  while (!WindowShouldClose()) {
+    if (frames == 30) {
+      begin = GetTime();
+    }
+
+    ParticlesBurst(&pool, &burst, SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
+    ParticlesUpdate(&pool, benchFrameTime);
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+    DrawParticles(&pool, atlas->texture, &frame, 1, WHITE);
+    EndDrawing();
+
+    frames++;
+    if (frames > 30) {
+      elapsed = GetTime() - begin;
+      if (elapsed >= options->seconds) {
+        break;
+      }
+    }
+  }
+
+  if (elapsed > 0) {
+    char name[64];
+    snprintf(name, sizeof(name), "render.particles.%d.%d", options->particles,
+             options->particleRate);
+    Report(name, (frames - 30) / elapsed, "frames/s");
+  }
+
+  ParticlesFree(&pool);
+}
+
+// A full game frame with options->renderBirds birds spread over the screen
+// and options->renderPipes pipes, no frame cap and no vsync
+static void BenchRender(const BenchOptions *options) {
+  SetTraceLogLevel(LOG_WARNING);
+  InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Flappy birds bench");
+  if (!IsWindowReady()) {
+    printf("# render skipped, no window\n");
+    return;
+  }
+  SetTargetFPS(0);
+
+  Atlas atlas;
+  BirdSkins skins;
+  if (!LoadBenchAtlas(&atlas, &skins)) {
+    printf("# render skipped, no assets\n");
+    CloseWindow();
+    return;
+  }
+
+  LowResTarget lowResTarget;
+  bool lowRes = options->lowRes && LoadLowResTarget(&lowResTarget);
+  if (options->lowRes && !lowRes) {
+    printf("# low-res target unavailable, drawing at full size\n");
+  }
+
+  // Laid out like the game's scene: background, pipes, birds, base
+  int birdCount = options->renderBirds;
+  int pipeCount = options->renderPipes;
+  int firstPipe = 1;
+  int firstBird = firstPipe + pipeCount * 2;
+  int baseIndex = firstBird + birdCount;
+  Entities scene;
+  SimBird *birds = malloc(sizeof(SimBird) * (birdCount > 0 ? birdCount : 1));
+  if (birds == NULL || !EntitiesInit(&scene, baseIndex + 1)) {
+    fprintf(stderr, "Cannot allocate the rendered scene\n");
+    exit(1);
+  }
+  EntityAddScrollingLayer(&scene, &atlas, SPRITE_BACKGROUND_DAY, BG_POS_Y,
+                          BG_SPEED);
+  for (int i = 0; i < pipeCount; i++) {
+    EntityAddPipe(&scene, &atlas, SPRITE_PIPE_GREEN);
+  }
+  for (int i = 0; i < birdCount; i++) {
+    EntityAddBird(&scene, &skins, SKIN_BLUE);
+  }
+  EntityAddScrollingLayer(&scene, &atlas, SPRITE_BASE, BASE_POS_Y,
+                          BASE_SPEED);
+
+  SimState start;
+  SimInit(&start, BENCH_SEED);
+  uint64_t rng = BENCH_SEED;
+  for (int i = 0; i < birdCount; i++) {
+    birds[i] = start.bird;
+    birds[i].x = (float)(NextRandom(&rng) % SCREEN_WIDTH);
+    birds[i].y = SimFromFloat((float)(NextRandom(&rng) % BASE_POS_Y));
+  }
+  for (int i = 0; i < pipeCount; i++) {
+    Pipe pipe = {.x = (float)SCREEN_WIDTH * i / pipeCount,
+                 .gapY = PIPE_GAP_MIN_Y +
+                         NextRandom(&rng) % (PIPE_GAP_MAX_Y - PIPE_GAP_MIN_Y)};
+    EntityPlacePipe(&scene, firstPipe + i * 2, &pipe, pipe.x);
+  }
+
+  // Warm up the driver before timing
+  uint64_t frames = 0;
+  double begin = 0;
+  double elapsed = 0;
+  while (!WindowShouldClose()) {
+    if (frames == 30) {
+      begin = GetTime();
+    }
+
+    for (int i = 0; i < birdCount; i++) {
+      SimStepBird(&birds[i], NextRandom(&rng) % BENCH_JUMP_ODDS == 0);
+      SimAnimateBird(&birds[i]);
+      EntityFollowBird(&scene, firstBird + i, &birds[i], 1.0f);
+    }
+    UpdateEntities(&scene, SIM_DT);
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+    if (lowRes) {
+      BeginLowRes(&lowResTarget);
+    }
+    DrawEntities(&scene, 0, firstBird);
+    BeginSkins(&skins);
+    DrawEntities(&scene, firstBird, baseIndex);
+    EndSkins();
+    DrawEntities(&scene, baseIndex, baseIndex + 1);
+    if (lowRes) {
+      EndLowRes();
+      DrawLowRes(&lowResTarget);
+    }
+    EndDrawing();
+
+    frames++;
+    if (frames > 30) {
+      elapsed = GetTime() - begin;
+      if (elapsed >= options->seconds) {
+        break;
+      }
+    }
+  }
+
+  if (elapsed > 0) {
+    char name[64];
+    snprintf(name, sizeof(name), "render.%s%d.%d", lowRes ? "lowres." : "",
+             birdCount, pipeCount);
+    Report(name, (frames - 30) / elapsed, "frames/s");
+  }
+
+  EntitiesFree(&scene);
+  free(birds);
+  if (lowRes) {
+    UnloadLowResTarget(&lowResTarget);
+  }
+  if (options->ghosts > 0) {
+    BenchGhosts(options, &skins);
+  }
+  if (options->particles > 0) {
+    BenchDrawParticles(options, &atlas);
+  }
+  UnloadSkins(&skins);
+  UnloadAtlas(&atlas);
+  CloseWindow();
+}
+#endif
+
+int main(int argc, char **argv) {
+  BenchOptions options = {.birds = 10000,
+                          .seconds = 1.0,
+                          .render = true,
+                          .renderBirds = 100,
+                          .renderPipes = PIPE_COUNT,
+                          .ghosts = 5000,
+                          .particles = 10000,
+                          .particleRate = 200};
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--birds") == 0 && i + 1 < argc) {
+      options.birds = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      options.seconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      options.threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--no-render") == 0) {
+      options.render = false;
+    } else if (strcmp(argv[i], "--render-birds") == 0 && i + 1 < argc) {
+      options.renderBirds = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--render-pipes") == 0 && i + 1 < argc) {
+      options.renderPipes = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--low-res") == 0) {
+      options.lowRes = true;
+    } else if (strcmp(argv[i], "--ghosts") == 0 && i + 1 < argc) {
+      options.ghosts = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--particles") == 0 && i + 1 < argc) {
+      options.particles = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--particle-rate") == 0 && i + 1 < argc) {
+      options.particleRate = atoi(argv[++i]);
+    } else {
+      fprintf(stderr,
+              "usage: %s [--birds N] [--seconds S] [--threads N] [--no-render]"
+              " [--render-birds N] [--render-pipes N] [--ghosts N]"
+              " [--low-res] [--particles N] [--particle-rate N]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  // Zero is fine for the counts below, it leaves that part out
+  if (options.birds < 1 || options.seconds <= 0 || options.threads < 0 ||
+      options.renderBirds < 0 || options.renderPipes < 0 ||
+      options.ghosts < 0 || options.particles < 0 ||
+      options.particleRate < 0) {
+    fprintf(stderr, "--birds and --seconds must be positive, --threads,"
+                    " --render-birds, --render-pipes, --ghosts, --particles"
+                    " and --particle-rate not negative\n");
+    return 1;
+  }
+
+  printf("# kernel=%s sim=%s birds=%d seconds=%g\n", BatchKernelName(),
+         SIM_NUMBERS, options.birds, options.seconds);
+  BenchGolden();
+  BenchPipeSeek();
+  BenchSnapshots();
+  BenchSimSingle(&options);
+  BenchSimBatch(&options);
+  BenchCollision(&options);
+  BenchEpisodes(&options);
+  if (options.particles > 0) {
+    BenchParticles(&options);
+  }
+
+#ifdef BENCH_RENDER
+  if (options.render) {
+    BenchRender(&options);
+  }
+#else
+  printf("# render skipped, built without raylib\n");
+#endif
+  return 0;
+}
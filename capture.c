@@ -0,0 +1,247 @@
+#include "capture.h"
+#include "raylib.h"
+
+#include "rlgl.h"
+
+// rlgl has no pixel buffer objects, this is desktop GL 3.3 like rlgl's
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include <assert.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Rows come bottom up from GL, y4m wants them top down. BT.601 limited
+// range, chroma averaged over every 2x2 block.
+static void WriteFrame(const uint8_t *rgba, int width, int height,
+                       uint8_t *yuv, FILE *out) {
+  uint8_t *luma = yuv;
+  uint8_t *u = luma + width * height;
+  uint8_t *v = u + width * height / 4;
+  for (int y = 0; y < height; y++) {
+    const uint8_t *row = rgba + (size_t)(height - 1 - y) * width * 4;
+    for (int x = 0; x < width; x++) {
+      int r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+      luma[y * width + x] =
+          (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+  }
+  for (int y = 0; y < height; y += 2) {
+    const uint8_t *top = rgba + (size_t)(height - 1 - y) * width * 4;
+    const uint8_t *bottom = top - (size_t)width * 4;
+    for (int x = 0; x < width; x += 2) {
+      int r = top[x * 4] + top[x * 4 + 4] + bottom[x * 4] +
+              bottom[x * 4 + 4];
+      int g = top[x * 4 + 1] + top[x * 4 + 5] + bottom[x * 4 + 1] +
+              bottom[x * 4 + 5];
+      int b = top[x * 4 + 2] + top[x * 4 + 6] + bottom[x * 4 + 2] +
+              bottom[x * 4 + 6];
+      int i = y / 2 * (width / 2) + x / 2;
+      u[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+      v[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+    }
+  }
+
+  fputs("FRAME\n", out);
+  fwrite(yuv, 1, (size_t)width * height * 3 / 2, out);
+}
+
+static void *Encoder(void *arg) {
+  Capture *capture = arg;
+
+  pthread_mutex_lock(&capture->lock);
+  for (;;) {
+    while (capture->count == 0 && !capture->stop) {
+      pthread_cond_wait(&capture->queued, &capture->lock);
+    }
+    if (capture->count == 0) {
+      break; // Stopped and drained
+    }
+    // The main thread only writes past count, so the head slot is ours
+    const uint8_t *frame = capture->slots[capture->head];
+    pthread_mutex_unlock(&capture->lock);
+
+    WriteFrame(frame, capture->width, capture->height, capture->yuv,
+               capture->out);
+
+    pthread_mutex_lock(&capture->lock);
+    capture->head = (capture->head + 1) % CAPTURE_QUEUE;
+    capture->count--;
+    pthread_cond_signal(&capture->freed);
+  }
+  pthread_mutex_unlock(&capture->lock);
+  return NULL;
+}
+
+static void FreeSlots(Capture *capture) {
+  for (int i = 0; i < CAPTURE_QUEUE; i++) {
+    free(capture->slots[i]);
+  }
+  free(capture->yuv);
+}
+
+static void CloseOutput(Capture *capture) {
+  if (capture->piped) {
+    pclose(capture->out);
+  } else {
+    fclose(capture->out);
+  }
+}
+
+// .y4m is written as is, anything else goes through ffmpeg
+static FILE *OpenOutput(const char *path, bool *piped) {
+  const char *extension = strrchr(path, '.');
+  *piped = extension == NULL || strcmp(extension, ".y4m") != 0;
+  if (!*piped) {
+    return fopen(path, "wb");
+  }
+  if (strchr(path, '\'') != NULL) {
+    return NULL; // Has to fit in the quotes below
+  }
+  // A dead ffmpeg must fail the writes, not kill the game
+  signal(SIGPIPE, SIG_IGN);
+  return popen(TextFormat("ffmpeg -loglevel error -y -f yuv4mpegpipe -i - "
+                          "-pix_fmt yuv420p '%s'",
+                          path),
+               "w");
+}
+
+bool CaptureOpen(Capture *capture, const char *path, bool wait) {
+  assert(capture != NULL);
+  assert(path != NULL);
+
+  // 4:2:0 needs even sizes, an odd last row or column is left out
+  *capture = (Capture){.width = GetRenderWidth() & ~1,
+                       .height = GetRenderHeight() & ~1,
+                       .wait = wait};
+  size_t size = (size_t)capture->width * capture->height * 4;
+  bool allocated = true;
+  for (int i = 0; i < CAPTURE_QUEUE; i++) {
+    capture->slots[i] = malloc(size);
+    allocated &= capture->slots[i] != NULL;
+  }
+  capture->yuv = malloc(size / 4 * 3 / 2);
+  if (!allocated || capture->yuv == NULL) {
+    TraceLog(LOG_ERROR, "Cannot allocate the capture queue");
+    FreeSlots(capture);
+    return false;
+  }
+
+  capture->out = OpenOutput(path, &capture->piped);
+  if (capture->out == NULL) {
+    TraceLog(LOG_ERROR, "Cannot write capture to %s", path);
+    FreeSlots(capture);
+    return false;
+  }
+  fprintf(capture->out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+          capture->width, capture->height, CAPTURE_FPS);
+
+  pthread_mutex_init(&capture->lock, NULL);
+  pthread_cond_init(&capture->queued, NULL);
+  pthread_cond_init(&capture->freed, NULL);
+  if (pthread_create(&capture->encoder, NULL, Encoder, capture) != 0) {
+    TraceLog(LOG_ERROR, "Cannot start the capture encoder");
+    pthread_cond_destroy(&capture->freed);
+    pthread_cond_destroy(&capture->queued);
+    pthread_mutex_destroy(&capture->lock);
+    CloseOutput(capture);
+    FreeSlots(capture);
+    return false;
+  }
+
+  // Streamed into by the GPU, read back once
+  glGenBuffers(2, capture->pbo);
+  for (int i = 0; i < 2; i++) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo[i]);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL,
+                 GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  TraceLog(LOG_INFO, "Capturing %dx%d at %d FPS to %s", capture->width,
+           capture->height, CAPTURE_FPS, path);
+  return true;
+}
+
+// Hands the frame in pbo[index] to the encoder. By now the GPU has had a
+// whole frame to fill it, so mapping does not wait.
+static void CopyOut(Capture *capture, int index) {
+  pthread_mutex_lock(&capture->lock);
+  while (capture->wait && capture->count == CAPTURE_QUEUE) {
+    pthread_cond_wait(&capture->freed, &capture->lock);
+  }
+  bool full = capture->count == CAPTURE_QUEUE;
+  int slot = (capture->head + capture->count) % CAPTURE_QUEUE;
+  pthread_mutex_unlock(&capture->lock);
+  if (full) {
+    capture->dropped++;
+    return;
+  }
+
+  size_t size = (size_t)capture->width * capture->height * 4;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo[index]);
+  const void *pixels =
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size,
+                       GL_MAP_READ_BIT);
+  bool mapped = pixels != NULL;
+  if (mapped) {
+    memcpy(capture->slots[slot], pixels, size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (!mapped) {
+    capture->dropped++;
+    return;
+  }
+
+  pthread_mutex_lock(&capture->lock);
+  capture->count++;
+  pthread_cond_signal(&capture->queued);
+  pthread_mutex_unlock(&capture->lock);
+  capture->frames++;
+}
+
+void CaptureFrame(Capture *capture) {
+  assert(capture != NULL);
+
+  // What raylib still batches has to reach the framebuffer first
+  rlDrawRenderBatchActive();
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo[capture->next]);
+  glReadPixels(0, 0, capture->width, capture->height, GL_RGBA,
+               GL_UNSIGNED_BYTE, NULL);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  // The other one holds the previous frame
+  int previous = capture->next ^ 1;
+  if (capture->pending) {
+    CopyOut(capture, previous);
+  }
+  capture->pending = true;
+  capture->next = previous;
+}
+
+void CaptureClose(Capture *capture) {
+  assert(capture != NULL);
+
+  if (capture->pending) {
+    CopyOut(capture, capture->next ^ 1);
+  }
+
+  pthread_mutex_lock(&capture->lock);
+  capture->stop = true;
+  pthread_cond_signal(&capture->queued);
+  pthread_mutex_unlock(&capture->lock);
+  pthread_join(capture->encoder, NULL);
+
+  TraceLog(LOG_INFO, "Captured %llu frames, dropped %llu",
+           (unsigned long long)capture->frames,
+           (unsigned long long)capture->dropped);
+  glDeleteBuffers(2, capture->pbo);
+  pthread_cond_destroy(&capture->freed);
+  pthread_cond_destroy(&capture->queued);
+  pthread_mutex_destroy(&capture->lock);
+  CloseOutput(capture);
+  FreeSlots(capture);
+}
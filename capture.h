@@ -0,0 +1,55 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+// --capture: records the window as Y4M video. glReadPixels() straight into
+// client memory waits for the GPU to finish the frame, so each frame is read
+// into one of two pixel buffer objects instead and copied out of the other
+// one, which the GPU filled a frame earlier. An encoder thread converts the
+// copies to YUV 4:2:0 and writes them, to a .y4m file as is, or through an
+// ffmpeg pipe for any other extension. Frames are one video frame each at
+// CAPTURE_FPS, see the offline replay rendering in main.c.
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define CAPTURE_FPS 60
+// Frames waiting for the encoder, each width * height * 4 bytes
+#define CAPTURE_QUEUE 4
+
+typedef struct {
+  int width;
+  int height;
+  unsigned int pbo[2];
+  int next;        // PBO the next frame is read into
+  bool pending;    // The other PBO holds a frame not copied out yet
+  bool wait;       // Wait for the encoder instead of dropping frames
+  uint64_t frames; // Handed to the encoder
+  uint64_t dropped;
+
+  FILE *out;
+  bool piped;
+  uint8_t *yuv; // The encoder's converted frame
+
+  // Frames for the encoder, written by the main thread under lock
+  uint8_t *slots[CAPTURE_QUEUE];
+  int head;
+  int count;
+  bool stop;
+  pthread_t encoder;
+  pthread_mutex_t lock;
+  pthread_cond_t queued;
+  pthread_cond_t freed;
+} Capture;
+
+// Captures the whole framebuffer, call after the window opened. With wait,
+// a busy encoder slows the frame down instead, for offline rendering.
+bool CaptureOpen(Capture *capture, const char *path, bool wait);
+// Copies out the last pending frame, then waits for the encoder to finish
+void CaptureClose(Capture *capture);
+
+// Reads back what was drawn so far, call right before EndDrawing()
+void CaptureFrame(Capture *capture);
+
+#endif
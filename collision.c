@@ -0,0 +1,122 @@
+#include "collision.h"
+#include "fixed.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+
+#ifdef SIM_FIXED_POINT
+
+// Pipe spacings in distance, rounded down. In integers on the exact 24.8
+// values, a float division could be a reciprocal multiply.
+static int SpacingsFloor(float distance) {
+  SimValue value = SimFromFloat(distance);
+  SimValue spacing = SIM_VALUE(PIPE_SPACING);
+  return value >= 0 ? value / spacing : -((spacing - 1 - value) / spacing);
+}
+
+#else
+
+static int SpacingsFloor(float distance) {
+  return (int)floorf(distance / PIPE_SPACING);
+}
+
+#endif
+
+static int SpacingsCeil(float distance) { return -SpacingsFloor(-distance); }
+
+int PipeRingOverlapping(const PipeRing *ring, float left, float right,
+                        const Pipe *out[COLLISION_MAX_PIPES]) {
+  assert(ring != NULL);
+  assert(out != NULL);
+
+  // Pipe i starts at first + i * PIPE_SPACING, so the overlapping indices
+  // follow from the bird's edges without walking the ring
+  float first = PipeRingGet(ring, 0)->x;
+  int lo = SpacingsCeil(left - first - PIPE_WIDTH);
+  int hi = SpacingsFloor(right - first);
+  lo = lo < 0 ? 0 : lo;
+  hi = hi > PIPE_COUNT - 1 ? PIPE_COUNT - 1 : hi;
+
+  int count = 0;
+  for (int i = lo; i <= hi && count < COLLISION_MAX_PIPES; i++) {
+    const Pipe *pipe = PipeRingGet(ring, i);
+    if (pipe->x <= right && pipe->x + PIPE_WIDTH >= left) {
+      out[count++] = pipe;
+    }
+  }
+  return count;
+}
+
+#ifdef SIM_FIXED_POINT
+
+static int64_t ClampValue(int64_t value, int64_t min, int64_t max) {
+  int64_t result = value < min ? min : value;
+  return result > max ? max : result;
+}
+
+// Squares of 24.8 values need 64 bits
+static bool CircleHitsRect(float x, float y, float radius, float left,
+                           float top, float right, float bottom) {
+  int64_t cx = SimFromFloat(x);
+  int64_t cy = SimFromFloat(y);
+  int64_t r = SimFromFloat(radius);
+  int64_t dx = cx - ClampValue(cx, SimFromFloat(left), SimFromFloat(right));
+  int64_t dy = cy - ClampValue(cy, SimFromFloat(top), SimFromFloat(bottom));
+  return dx * dx + dy * dy < r * r;
+}
+
+#else
+
+static float ClampFloat(float value, float min, float max) {
+  float result = value < min ? min : value;
+  return result > max ? max : result;
+}
+
+static bool CircleHitsRect(float x, float y, float radius, float left,
+                           float top, float right, float bottom) {
+  float dx = x - ClampFloat(x, left, right);
+  float dy = y - ClampFloat(y, top, bottom);
+  return dx * dx + dy * dy < radius * radius;
+}
+
+#endif
+
+bool CircleHitsPipe(const Pipe *pipe, float x, float y, float radius) {
+  assert(pipe != NULL);
+
+  float gapTop = PipeGapTop(pipe);
+  float gapBottom = PipeGapBottom(pipe);
+  float right = pipe->x + PIPE_WIDTH;
+
+  return CircleHitsRect(x, y, radius, pipe->x, gapTop - PIPE_HEIGHT, right,
+                        gapTop) ||
+         CircleHitsRect(x, y, radius, pipe->x, gapBottom, right,
+                        gapBottom + PIPE_HEIGHT);
+}
+
+bool PipeRingPassed(const PipeRing *ring, float x) {
+  assert(ring != NULL);
+
+  // The last pipe whose right edge is left of x
+  float first = PipeRingGet(ring, 0)->x;
+  int i = SpacingsFloor(x - first - PIPE_WIDTH);
+  if (i < 0 || i >= PIPE_COUNT) {
+    return false;
+  }
+
+  float right = PipeRingGet(ring, i)->x + PIPE_WIDTH;
+  return right < x && right + BASE_SPEED * SIM_DT >= x;
+}
+
+const Pipe *PipeRingAhead(const PipeRing *ring, float x) {
+  assert(ring != NULL);
+
+  for (int i = 0; i < PIPE_COUNT - 1; i++) {
+    const Pipe *pipe = PipeRingGet(ring, i);
+    if (pipe->x + PIPE_WIDTH >= x) {
+      return pipe;
+    }
+  }
+  return PipeRingGet(ring, PIPE_COUNT - 1);
+}
@@ -0,0 +1,38 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+// Bird vs pipe tests. The broadphase picks the pipes whose x-range overlaps
+// the bird in O(1) from the ring layout, the narrowphase tests the bird's
+// circle against the two rectangles of each of those pipes.
+
+#include "pipes.h"
+
+#include <stdbool.h>
+
+// Pipes are PIPE_SPACING apart, so a bird narrower than the free space
+// between two pipes overlaps at most two of them
+#define COLLISION_MAX_PIPES 2
+
+// Writes the pipes overlapping [left, right] to out, returns how many
+int PipeRingOverlapping(const PipeRing *ring, float left, float right,
+                        const Pipe *out[COLLISION_MAX_PIPES]);
+
+// Vertical extents of the top and bottom pipe
+static inline float PipeGapTop(const Pipe *pipe) {
+  return pipe->gapY - PIPE_GAP / 2.0f;
+}
+static inline float PipeGapBottom(const Pipe *pipe) {
+  return pipe->gapY + PIPE_GAP / 2.0f;
+}
+
+// Circle in screen pixels against both rectangles of a pipe
+bool CircleHitsPipe(const Pipe *pipe, float x, float y, float radius);
+
+// First pipe whose right edge is at or right of x, the one a bird at x
+// has to clear next
+const Pipe *PipeRingAhead(const PipeRing *ring, float x);
+
+// True when the pipe's right edge crossed x during the last tick
+bool PipeRingPassed(const PipeRing *ring, float x);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// Tuning constants shared by the simulation and the renderer
+
+#define SCREEN_HEIGHT 768
+#define SCREEN_WIDTH 1300
+
+#define SCALE 1.5f
+
+#define MAX_VELOCITY 800
+#define MIN_VELOCITY -400
+
+#define BG_SPEED 40.0f
+#define BG_POS_Y 0
+#define BASE_SPEED (BG_SPEED * 3)
+#define BASE_POS_Y 600
+
+#define PIPE_GAP 300
+#define PIPE_SPACING 250
+
+// Simulation runs at a fixed rate, independent of the render rate
+#define SIM_HZ 120
+#define SIM_DT (1.0f / SIM_HZ)
+
+// TODO: Tune these
+#define GRAVITY 980.0f
+#define JUMP_VELOCITY -400.0f
+#define FALL_VELOCITY_MIN -1200.0f
+#define FALL_VELOCITY_MAX 1500.0f
+// Per-tick velocity damping, sqrt(0.99) so the arc matches the old 60 FPS loop
+#define VELOCITY_DAMPING 0.99498744f
+
+#define BIRD_START_X 100.0f
+#define BIRD_START_Y (SCREEN_HEIGHT / 2.0f)
+// Half the width of the 34px bird sprites
+#define BIRD_RADIUS 17.0f
+
+// Flap animation, advanced on sim ticks so collision sees the drawn frame
+#define BIRD_FRAMES 3
+#define BIRD_FRAME_TICKS (SIM_HZ / 8)
+
+#endif
@@ -0,0 +1,188 @@
+#include "dxt.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+static uint16_t Pack565(const uint8_t *rgb) {
+  return (uint16_t)((rgb[0] >> 3) << 11 | (rgb[1] >> 2) << 5 | rgb[2] >> 3);
+}
+
+static void Unpack565(uint16_t color, int *rgb) {
+  int r = color >> 11 & 31;
+  int g = color >> 5 & 63;
+  int b = color & 31;
+  rgb[0] = r << 3 | r >> 2;
+  rgb[1] = g << 2 | g >> 4;
+  rgb[2] = b << 3 | b >> 2;
+}
+
+// The four colors a block decodes to, the fourth is transparent black in the
+// three color mode (c0 <= c1)
+static void Palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+  Unpack565(c0, palette[0]);
+  Unpack565(c1, palette[1]);
+  for (int i = 0; i < 3; i++) {
+    int a = palette[0][i];
+    int b = palette[1][i];
+    if (c0 > c1) {
+      palette[2][i] = (2 * a + b) / 3;
+      palette[3][i] = (a + 2 * b) / 3;
+    } else {
+      palette[2][i] = (a + b) / 2;
+      palette[3][i] = 0;
+    }
+  }
+}
+
+static int Distance(const int *a, const uint8_t *b) {
+  int dr = a[0] - b[0];
+  int dg = a[1] - b[1];
+  int db = a[2] - b[2];
+  return dr * dr + dg * dg + db * db;
+}
+
+// Index of every pixel for these endpoints, returns the summed error over
+// the opaque pixels
+static int Fit(uint8_t pixels[16][4], uint16_t c0, uint16_t c1,
+               uint32_t *indices) {
+  int palette[4][3];
+  Palette(c0, c1, palette);
+  int choices = c0 > c1 ? 4 : 3; // Index 3 is reserved for transparency
+
+  int error = 0;
+  uint32_t bits = 0;
+  for (int p = 0; p < 16; p++) {
+    int best = 3;
+    if (pixels[p][3] >= DXT_ALPHA_THRESHOLD) {
+      int bestError = Distance(palette[0], pixels[p]);
+      best = 0;
+      for (int i = 1; i < choices; i++) {
+        int e = Distance(palette[i], pixels[p]);
+        if (e < bestError) {
+          bestError = e;
+          best = i;
+        }
+      }
+      error += bestError;
+    }
+    bits |= (uint32_t)best << (2 * p);
+  }
+  *indices = bits;
+  return error;
+}
+
+// Tries every pair of the block's own colors plus its bounding box corners
+// as endpoints. Sprite blocks hold a handful of flat colors, so picking
+// endpoints from them is usually exact.
+static void CompressBlock(uint8_t pixels[16][4], uint8_t *out) {
+  uint16_t colors[18];
+  int count = 0;
+  bool transparent = false;
+  uint8_t low[3] = {255, 255, 255};
+  uint8_t high[3] = {0, 0, 0};
+  for (int p = 0; p < 16; p++) {
+    if (pixels[p][3] < DXT_ALPHA_THRESHOLD) {
+      transparent = true;
+      continue;
+    }
+    for (int i = 0; i < 3; i++) {
+      low[i] = pixels[p][i] < low[i] ? pixels[p][i] : low[i];
+      high[i] = pixels[p][i] > high[i] ? pixels[p][i] : high[i];
+    }
+    uint16_t color = Pack565(pixels[p]);
+    bool seen = false;
+    for (int i = 0; i < count && !seen; i++) {
+      seen = colors[i] == color;
+    }
+    if (!seen) {
+      colors[count++] = color;
+    }
+  }
+  if (count == 0) {
+    // All transparent, c0 == c1 selects the three color mode
+    memset(out, 0, 4);
+    memset(out + 4, 0xFF, 4);
+    return;
+  }
+  colors[count++] = Pack565(low);
+  colors[count++] = Pack565(high);
+
+  int bestError = -1;
+  uint16_t best0 = 0, best1 = 0;
+  uint32_t bestIndices = 0;
+  for (int i = 0; i < count; i++) {
+    for (int j = i; j < count; j++) {
+      uint16_t a = colors[i] > colors[j] ? colors[i] : colors[j];
+      uint16_t b = colors[i] > colors[j] ? colors[j] : colors[i];
+      // Larger first is the four color mode, only possible without
+      // transparency and with two different endpoints
+      uint16_t modes[2][2] = {{b, a}, {a, b}};
+      int modeCount = !transparent && a != b ? 2 : 1;
+      for (int m = 0; m < modeCount; m++) {
+        uint32_t indices;
+        int error = Fit(pixels, modes[m][0], modes[m][1], &indices);
+        if (bestError < 0 || error < bestError) {
+          bestError = error;
+          best0 = modes[m][0];
+          best1 = modes[m][1];
+          bestIndices = indices;
+        }
+      }
+    }
+  }
+
+  out[0] = best0 & 0xFF;
+  out[1] = best0 >> 8;
+  out[2] = best1 & 0xFF;
+  out[3] = best1 >> 8;
+  for (int i = 0; i < 4; i++) {
+    out[4 + i] = bestIndices >> (8 * i) & 0xFF;
+  }
+}
+
+void DxtCompress(const uint8_t *rgba, int width, int height, uint8_t *out) {
+  assert(rgba != NULL);
+  assert(out != NULL);
+  assert(width % 4 == 0 && height % 4 == 0);
+
+  for (int by = 0; by < height; by += 4) {
+    for (int bx = 0; bx < width; bx += 4) {
+      uint8_t pixels[16][4];
+      for (int y = 0; y < 4; y++) {
+        memcpy(pixels[y * 4], rgba + ((size_t)(by + y) * width + bx) * 4, 16);
+      }
+      CompressBlock(pixels, out);
+      out += DXT_BLOCK_SIZE;
+    }
+  }
+}
+
+void DxtDecompress(const uint8_t *blocks, int width, int height,
+                   uint8_t *rgba) {
+  assert(blocks != NULL);
+  assert(rgba != NULL);
+  assert(width % 4 == 0 && height % 4 == 0);
+
+  for (int by = 0; by < height; by += 4) {
+    for (int bx = 0; bx < width; bx += 4) {
+      uint16_t c0 = (uint16_t)(blocks[0] | blocks[1] << 8);
+      uint16_t c1 = (uint16_t)(blocks[2] | blocks[3] << 8);
+      uint32_t indices = (uint32_t)blocks[4] | (uint32_t)blocks[5] << 8 |
+                         (uint32_t)blocks[6] << 16 | (uint32_t)blocks[7] << 24;
+      int palette[4][3];
+      Palette(c0, c1, palette);
+
+      for (int p = 0; p < 16; p++) {
+        int index = indices >> (2 * p) & 3;
+        uint8_t *out =
+            rgba + ((size_t)(by + p / 4) * width + bx + p % 4) * 4;
+        for (int i = 0; i < 3; i++) {
+          out[i] = (uint8_t)palette[index][i];
+        }
+        out[3] = c0 <= c1 && index == 3 ? 0 : 255;
+      }
+      blocks += DXT_BLOCK_SIZE;
+    }
+  }
+}
@@ -0,0 +1,27 @@
+#ifndef DXT_H
+#define DXT_H
+
+// DXT1 (BC1) texture compression, 4 bits per pixel against 32 for RGBA8.
+// Pixels with alpha below DXT_ALPHA_THRESHOLD become fully transparent,
+// which every sprite here already is. The packer compresses once at build
+// time, the decoder is only for CPU reads such as the collision masks. Does
+// not depend on raylib, the blocks match PIXELFORMAT_COMPRESSED_DXT1_RGBA.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DXT_BLOCK_SIZE 8 // Bytes per 4x4 pixel block
+#define DXT_ALPHA_THRESHOLD 128
+
+// Bytes of a width x height image, both multiples of 4
+static inline size_t DxtSize(int width, int height) {
+  return (size_t)(width / 4) * (height / 4) * DXT_BLOCK_SIZE;
+}
+
+// rgba is width x height RGBA8, out receives DxtSize() bytes
+void DxtCompress(const uint8_t *rgba, int width, int height, uint8_t *out);
+// The reverse, rgba receives width x height RGBA8
+void DxtDecompress(const uint8_t *blocks, int width, int height,
+                   uint8_t *rgba);
+
+#endif
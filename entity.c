@@ -0,0 +1,228 @@
+#include "entity.h"
+#include "config.h"
+
+#include "raymath.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+bool EntitiesInit(Entities *entities, int capacity) {
+  assert(entities != NULL);
+  assert(capacity > 0);
+
+  // One block, widest fields first so every array stays aligned
+  size_t n = (size_t)capacity;
+  size_t size = n * (sizeof(Rectangle *) + 6 * sizeof(float) +
+                     sizeof(Rectangle) + sizeof(Texture2D) + sizeof(Color) +
+                     2 * sizeof(uint8_t));
+  unsigned char *block = malloc(size);
+  if (block == NULL) {
+    return false;
+  }
+
+  *entities = (Entities){.capacity = capacity,
+                         .count = 0,
+                         .frames = (const Rectangle **)block};
+  float *floats = (float *)(block + n * sizeof(Rectangle *));
+  entities->x = floats;
+  entities->y = floats + n;
+  entities->rotation = floats + n * 2;
+  entities->vx = floats + n * 3;
+  entities->width = floats + n * 4;
+  entities->height = floats + n * 5;
+  entities->source = (Rectangle *)(floats + n * 6);
+  entities->texture = (Texture2D *)(entities->source + n);
+  entities->tint = (Color *)(entities->texture + n);
+  entities->flags = (uint8_t *)(entities->tint + n);
+  entities->frame = entities->flags + n;
+  return true;
+}
+
+void EntitiesFree(Entities *entities) {
+  assert(entities != NULL);
+
+  for (int i = 0; i < entities->count; i++) {
+    if (entities->flags[i] & ENTITY_WRAPPED) {
+      UnloadTexture(entities->texture[i]);
+    }
+  }
+  free(entities->frames);
+  *entities = (Entities){0};
+}
+
+int EntityAddSprite(Entities *entities, Texture2D texture, Rectangle source,
+                    float x, float y, uint8_t flags) {
+  assert(entities != NULL);
+  assert(entities->count < entities->capacity);
+
+  int i = entities->count++;
+  entities->frames[i] = NULL;
+  entities->frame[i] = 0;
+  entities->x[i] = x;
+  entities->y[i] = y;
+  entities->rotation[i] = 0;
+  entities->vx[i] = 0;
+  entities->width[i] = source.width * SCALE;
+  entities->height[i] = source.height * SCALE;
+  entities->source[i] = source;
+  entities->texture[i] = texture;
+  entities->tint[i] = WHITE;
+  entities->flags[i] = flags;
+  return i;
+}
+
+int EntityAddScrollingLayer(Entities *entities, const Atlas *atlas,
+                            Sprite sprite, float posY, float speed) {
+  assert(atlas != NULL);
+
+  int i = EntityAddSprite(entities, atlas->texture, atlas->rects[sprite], 0,
+                          posY, ENTITY_TILED);
+  entities->vx[i] = -speed;
+  return i;
+}
+
+int EntityAddWrappedLayer(Entities *entities, Texture2D texture, float posY,
+                          float speed) {
+  SetTextureWrap(texture, TEXTURE_WRAP_REPEAT);
+
+  Rectangle source = {0, 0, texture.width, texture.height};
+  int i = EntityAddSprite(entities, texture, source, 0, posY,
+                          ENTITY_TILED | ENTITY_WRAPPED);
+  entities->vx[i] = -speed;
+  return i;
+}
+
+int EntityAddBird(Entities *entities, const BirdSkins *skins, Skin skin) {
+  assert(skins != NULL);
+  assert(skin >= 0 && skin < SKIN_COUNT);
+
+  int i = EntityAddSprite(entities, skins->indices, skins->rects[0],
+                          BIRD_START_X, 0, ENTITY_CENTERED);
+  entities->frames[i] = skins->rects;
+  entities->tint[i] = SkinTint(skin, 255);
+  return i;
+}
+
+int EntityAddPipe(Entities *entities, const Atlas *atlas, Sprite sprite) {
+  assert(atlas != NULL);
+
+  Rectangle source = atlas->rects[sprite];
+  // Negative height flips the top pipe so its opening faces down
+  Rectangle flipped = {source.x, source.y, source.width, -source.height};
+
+  int top =
+      EntityAddSprite(entities, atlas->texture, flipped, 0, 0, ENTITY_HIDDEN);
+  EntityAddSprite(entities, atlas->texture, source, 0, 0, ENTITY_HIDDEN);
+  for (int i = top; i < top + 2; i++) {
+    entities->width[i] = PIPE_WIDTH;
+    entities->height[i] = PIPE_HEIGHT;
+  }
+  return top;
+}
+
+void EntityFollowBird(Entities *entities, int index, const SimBird *bird,
+                      float alpha) {
+  assert(entities != NULL);
+  assert(bird != NULL);
+  assert(index < entities->count);
+  assert(bird->frame < BIRD_FRAMES);
+
+  entities->x[index] = bird->x;
+  entities->y[index] =
+      Lerp(SimFloat(bird->previousY), SimFloat(bird->y), alpha);
+  entities->rotation[index] = SimFloat(bird->angle);
+  entities->frame[index] = bird->frame;
+}
+
+void EntityPlacePipe(Entities *entities, int index, const Pipe *pipe,
+                     float x) {
+  assert(entities != NULL);
+  assert(pipe != NULL);
+  assert(index + 1 < entities->count);
+
+  entities->x[index] = x;
+  entities->y[index] = pipe->gapY - PIPE_GAP / 2.0f - PIPE_HEIGHT;
+  entities->x[index + 1] = x;
+  entities->y[index + 1] = pipe->gapY + PIPE_GAP / 2.0f;
+  entities->flags[index] &= ~ENTITY_HIDDEN;
+  entities->flags[index + 1] &= ~ENTITY_HIDDEN;
+}
+
+void EntitiesFollowPipes(Entities *entities, int first, const PipeRing *pipes,
+                         bool moving, float alpha) {
+  assert(entities != NULL);
+  assert(pipes != NULL);
+  assert(first + PIPE_COUNT * 2 <= entities->count);
+
+  float offset = moving ? BASE_SPEED * SIM_DT * (1.0f - alpha) : 0;
+
+  for (int i = 0; i < PIPE_COUNT; i++) {
+    const Pipe *pipe = PipeRingGet(pipes, i);
+    int index = first + i * 2;
+    float x = pipe->x + offset;
+    if (x > SCREEN_WIDTH) {
+      entities->flags[index] |= ENTITY_HIDDEN;
+      entities->flags[index + 1] |= ENTITY_HIDDEN;
+      continue;
+    }
+    EntityPlacePipe(entities, index, pipe, x);
+  }
+}
+
+void UpdateEntities(Entities *entities, float dt) {
+  assert(entities != NULL);
+
+  for (int i = 0; i < entities->count; i++) {
+    float x = entities->x[i] + entities->vx[i] * dt;
+    if (entities->flags[i] & ENTITY_TILED) {
+      x = fmodf(x, entities->width[i]);
+    }
+    entities->x[i] = x;
+  }
+}
+
+void DrawEntities(const Entities *entities, int begin, int end) {
+  assert(entities != NULL);
+  assert(begin >= 0 && end <= entities->count);
+
+  for (int i = begin; i < end; i++) {
+    uint8_t flags = entities->flags[i];
+    if (flags & ENTITY_HIDDEN) {
+      continue;
+    }
+    Texture2D texture = entities->texture[i];
+    Color tint = entities->tint[i];
+    Rectangle source = entities->source[i];
+    Rectangle dest = {entities->x[i], entities->y[i], entities->width[i],
+                      entities->height[i]};
+    if (entities->frames[i] != NULL) {
+      // Animated sprites take the size of their frame
+      source = entities->frames[i][entities->frame[i]];
+      dest.width = source.width * SCALE;
+      dest.height = source.height * SCALE;
+    }
+
+    if (flags & ENTITY_WRAPPED) {
+      source = (Rectangle){-dest.x / SCALE, 0, SCREEN_WIDTH / SCALE,
+                           source.height};
+      dest = (Rectangle){0, dest.y, SCREEN_WIDTH, dest.height};
+      DrawTexturePro(texture, source, dest, (Vector2){0, 0}, 0, tint);
+    } else if (flags & ENTITY_TILED) {
+      int txW = dest.width;
+      int txH = dest.height;
+      int renderCount = 2 + SCREEN_WIDTH / txW;
+      for (int t = 0; t < renderCount; t++) {
+        Rectangle tile = {dest.x + (t * txW), dest.y, txW, txH};
+        DrawTexturePro(texture, source, tile, (Vector2){0, 0}, 0, tint);
+      }
+    } else if (flags & ENTITY_CENTERED) {
+      Vector2 origin = {dest.width / 2.0f, dest.height / 2.0f};
+      DrawTexturePro(texture, source, dest, origin, entities->rotation[i],
+                     tint);
+    } else {
+      DrawTexturePro(texture, source, dest, (Vector2){0, 0},
+                     entities->rotation[i], tint);
+    }
+  }
+}
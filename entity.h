@@ -0,0 +1,85 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+// Everything on screen that is one sprite per entity: the scrolling layers,
+// the pipes and the bird. Entities are indices into arrays per component,
+// transform, velocity, sprite and animation, so the systems below are one
+// linear pass each. Sync systems copy sim state in, UpdateEntities() moves
+// what moves on its own and DrawEntities() only draws. Ghosts keep their own
+// quad batch, see ghost.h.
+
+#include "atlas.h"
+#include "pipes.h"
+#include "raylib.h"
+#include "sim.h"
+#include "skins.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sprite flags
+#define ENTITY_CENTERED 1 // x, y is the center and rotation turns around it
+#define ENTITY_TILED 2    // Repeats across the screen, x within one tile
+#define ENTITY_WRAPPED 4  // Like tiled, but the owned texture repeats itself
+#define ENTITY_HIDDEN 8
+
+typedef struct {
+  int capacity;
+  int count;
+  // Animation: source is frames[frame] when frames is not NULL
+  const Rectangle **frames;
+  uint8_t *frame;
+  // Transform, left edge or center and degrees
+  float *x;
+  float *y;
+  float *rotation;
+  // Velocity in pixels per second, only the layers move on their own
+  float *vx;
+  // Sprite, drawn width x height screen pixels
+  float *width;
+  float *height;
+  Rectangle *source;
+  Texture2D *texture;
+  Color *tint;
+  uint8_t *flags;
+} Entities;
+
+bool EntitiesInit(Entities *entities, int capacity);
+// Unloads the textures of wrapped entities too, atlas ones are left alone
+void EntitiesFree(Entities *entities);
+
+// Each returns the index of the new entity. Draw order is index order.
+int EntityAddSprite(Entities *entities, Texture2D texture, Rectangle source,
+                    float x, float y, uint8_t flags);
+int EntityAddScrollingLayer(Entities *entities, const Atlas *atlas,
+                            Sprite sprite, float posY, float speed);
+// Takes a standalone texture and sets it to repeat, the scroll then becomes
+// a source offset instead of moving tiles
+int EntityAddWrappedLayer(Entities *entities, Texture2D texture, float posY,
+                          float speed);
+// Draw with the skins shader, see BeginSkins()
+int EntityAddBird(Entities *entities, const BirdSkins *skins, Skin skin);
+// Two entities, the flipped top half first
+int EntityAddPipe(Entities *entities, const Atlas *atlas, Sprite sprite);
+
+// alpha is how far we are between the previous and the current sim tick
+void EntityFollowBird(Entities *entities, int index, const SimBird *bird,
+                      float alpha);
+// Top and bottom half of the pipe from EntityAddPipe() at index, left edge
+// at x
+void EntityPlacePipe(Entities *entities, int index, const Pipe *pipe,
+                     float x);
+// first is the first of PIPE_COUNT EntityAddPipe() calls. Pipes move in
+// fixed ticks, so like the bird they are placed between the last two ticks,
+// and the ones past the screen are hidden.
+void EntitiesFollowPipes(Entities *entities, int first, const PipeRing *pipes,
+                         bool moving, float alpha);
+
+// Moves every entity by its velocity, tiled ones stay within one tile width
+// since scrolling by a whole tile looks the same
+void UpdateEntities(Entities *entities, float dt);
+
+// Entities begin to end - 1
+void DrawEntities(const Entities *entities, int begin, int end);
+
+#endif
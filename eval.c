@@ -0,0 +1,240 @@
+#include "eval.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <unistd.h>
+
+static inline uint64_t Range(uint32_t begin, uint32_t end) {
+  return (uint64_t)begin << 32 | end;
+}
+
+// Takes the front of the worker's own range, -1 when it is empty
+static int64_t PopFront(EvalWorker *worker) {
+  uint64_t range = atomic_load(&worker->range);
+  for (;;) {
+    uint32_t begin = range >> 32;
+    uint32_t end = (uint32_t)range;
+    if (begin >= end) {
+      return -1;
+    }
+    if (atomic_compare_exchange_weak(&worker->range, &range,
+                                     Range(begin + 1, end))) {
+      return begin;
+    }
+  }
+}
+
+// Moves the back half of some other worker's range to self and returns the
+// first stolen episode, -1 once every range is empty. A range is only
+// refilled by its owner once it is empty, with indices nobody has seen yet,
+// so the CAS never mistakes a refilled range for the one it read.
+static int64_t Steal(Evaluator *eval, int self) {
+  EvalWorker *thief = &eval->workers[self];
+  for (int n = 1; n < eval->workerCount; n++) {
+    EvalWorker *victim = &eval->workers[(self + n) % eval->workerCount];
+    uint64_t range = atomic_load(&victim->range);
+    for (;;) {
+      uint32_t begin = range >> 32;
+      uint32_t end = (uint32_t)range;
+      if (begin >= end) {
+        break;
+      }
+      uint32_t split = end - (end - begin + 1) / 2;
+      if (atomic_compare_exchange_weak(&victim->range, &range,
+                                       Range(begin, split))) {
+        // Our own range is empty, other thieves skip it until now
+        atomic_store(&thief->range, Range(split + 1, end));
+        thief->summary.steals++;
+        return split;
+      }
+    }
+  }
+  return -1;
+}
+
+static void PlayEpisode(Evaluator *eval, EvalSummary *summary, int episode) {
+  SimState state;
+  SimInit(&state, eval->seed);
+  state.masks = eval->masks;
+  SimStep(&state, (SimInput){.start = true});
+
+  uint32_t ticks = 0;
+  while (!state.dead && ticks < eval->maxTicks) {
+    bool jump = eval->policy(eval->user, episode, &state);
+    SimStep(&state, (SimInput){.jump = jump});
+    ticks++;
+  }
+
+  eval->results[episode] = (EvalResult){.score = state.score, .ticks = ticks};
+  summary->episodes++;
+  summary->totalScore += state.score;
+  summary->totalTicks += ticks;
+  if (summary->best < 0 || state.score > summary->bestScore ||
+      (state.score == summary->bestScore && episode < summary->best)) {
+    summary->bestScore = state.score;
+    summary->best = episode;
+  }
+  if (ticks > summary->longestTicks) {
+    summary->longestTicks = ticks;
+  }
+}
+
+static void Work(Evaluator *eval, int self) {
+  EvalWorker *worker = &eval->workers[self];
+  for (;;) {
+    int64_t episode = PopFront(worker);
+    if (episode < 0) {
+      episode = Steal(eval, self);
+    }
+    if (episode < 0) {
+      return;
+    }
+    PlayEpisode(eval, &worker->summary, (int)episode);
+  }
+}
+
+static void *Worker(void *data) {
+  EvalWorker *worker = data;
+  Evaluator *eval = worker->eval;
+
+  uint64_t seen = 0;
+  pthread_mutex_lock(&eval->lock);
+  for (;;) {
+    while (eval->generation == seen && !eval->quit) {
+      pthread_cond_wait(&eval->started, &eval->lock);
+    }
+    if (eval->quit) {
+      break;
+    }
+    seen = eval->generation;
+    pthread_mutex_unlock(&eval->lock);
+
+    Work(eval, worker->self);
+
+    pthread_mutex_lock(&eval->lock);
+    if (--eval->running == 0) {
+      pthread_cond_signal(&eval->finished);
+    }
+  }
+  pthread_mutex_unlock(&eval->lock);
+  return NULL;
+}
+
+bool EvalInit(Evaluator *eval, int threads) {
+  assert(eval != NULL);
+  assert(threads >= 0);
+
+  if (threads == 0) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cores < 1 ? 1 : (int)cores;
+  }
+  threads = threads > EVAL_MAX_THREADS ? EVAL_MAX_THREADS : threads;
+
+  eval->workerCount = 1;
+  eval->generation = 0;
+  eval->running = 0;
+  eval->quit = false;
+  for (int i = 0; i < EVAL_MAX_THREADS; i++) {
+    atomic_init(&eval->workers[i].range, 0);
+    eval->workers[i].eval = eval;
+    eval->workers[i].self = i;
+  }
+  if (pthread_mutex_init(&eval->lock, NULL) != 0) {
+    return false;
+  }
+  if (pthread_cond_init(&eval->started, NULL) != 0) {
+    pthread_mutex_destroy(&eval->lock);
+    return false;
+  }
+  if (pthread_cond_init(&eval->finished, NULL) != 0) {
+    pthread_cond_destroy(&eval->started);
+    pthread_mutex_destroy(&eval->lock);
+    return false;
+  }
+
+  // Fewer threads than asked for still works, just slower
+  for (int i = 1; i < threads; i++) {
+    int self = eval->workerCount;
+    if (pthread_create(&eval->threads[self], NULL, Worker,
+                       &eval->workers[self]) != 0) {
+      break;
+    }
+    eval->workerCount++;
+  }
+  return true;
+}
+
+void EvalFree(Evaluator *eval) {
+  assert(eval != NULL);
+
+  pthread_mutex_lock(&eval->lock);
+  eval->quit = true;
+  pthread_cond_broadcast(&eval->started);
+  pthread_mutex_unlock(&eval->lock);
+
+  for (int i = 1; i < eval->workerCount; i++) {
+    pthread_join(eval->threads[i], NULL);
+  }
+  pthread_cond_destroy(&eval->finished);
+  pthread_cond_destroy(&eval->started);
+  pthread_mutex_destroy(&eval->lock);
+}
+
+EvalSummary EvalRun(Evaluator *eval, int episodes, uint64_t seed,
+                    uint32_t maxTicks, const CollisionMasks *masks,
+                    EvalPolicy policy, void *user, EvalResult *results) {
+  assert(eval != NULL);
+  assert(episodes >= 0);
+  assert(policy != NULL);
+  assert(results != NULL || episodes == 0);
+
+  eval->policy = policy;
+  eval->user = user;
+  eval->seed = seed;
+  eval->maxTicks = maxTicks;
+  eval->masks = masks;
+  eval->results = results;
+
+  // Contiguous shares to start with, stealing evens out the rest
+  for (int i = 0; i < eval->workerCount; i++) {
+    uint32_t begin = (uint32_t)((uint64_t)episodes * i / eval->workerCount);
+    uint32_t end =
+        (uint32_t)((uint64_t)episodes * (i + 1) / eval->workerCount);
+    atomic_store(&eval->workers[i].range, Range(begin, end));
+    eval->workers[i].summary = (EvalSummary){.best = -1};
+  }
+
+  pthread_mutex_lock(&eval->lock);
+  eval->generation++;
+  eval->running = eval->workerCount - 1;
+  pthread_cond_broadcast(&eval->started);
+  pthread_mutex_unlock(&eval->lock);
+
+  Work(eval, 0);
+
+  pthread_mutex_lock(&eval->lock);
+  while (eval->running > 0) {
+    pthread_cond_wait(&eval->finished, &eval->lock);
+  }
+  pthread_mutex_unlock(&eval->lock);
+
+  // Every worker is parked again, their summaries are safe to read
+  EvalSummary total = {.best = -1};
+  for (int i = 0; i < eval->workerCount; i++) {
+    const EvalSummary *part = &eval->workers[i].summary;
+    total.episodes += part->episodes;
+    total.totalScore += part->totalScore;
+    total.totalTicks += part->totalTicks;
+    total.steals += part->steals;
+    if (part->longestTicks > total.longestTicks) {
+      total.longestTicks = part->longestTicks;
+    }
+    if (part->best >= 0 &&
+        (total.best < 0 || part->bestScore > total.bestScore ||
+         (part->bestScore == total.bestScore && part->best < total.best))) {
+      total.bestScore = part->bestScore;
+      total.best = part->best;
+    }
+  }
+  return total;
+}
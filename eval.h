@@ -0,0 +1,94 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+// Runs a generation of episodes on every core. One episode is one bird
+// played by a policy until it dies or hits the tick limit. Most birds die at
+// the first pipe while a few fly for minutes, so the episodes are not split
+// up front: every worker owns a range of episode indices and takes from the
+// front of it, and a worker that runs dry steals half of another worker's
+// remaining range from the back. Results are written per episode and summed
+// per worker, nothing on the hot path takes a lock.
+//
+// Episodes are stepped one SimState at a time through SimStep(), not as
+// BatchWorld shards. A policy sees the whole state of its bird and may
+// SimSave() it to search ahead, which a lane of a BatchWorld cannot give
+// it, and with masks set only SimStep() does the pixel-accurate collision,
+// BatchStep() always tests circles. Workloads that fit BatchStep(), fixed
+// or table-driven inputs with circle collision, step a BatchWorld directly,
+// see the batch suite in bench.c.
+
+#include "sim.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EVAL_MAX_THREADS 64
+
+// Decides whether the bird of episode flaps this tick. Called from worker
+// threads, so it must not touch shared state without its own care. A search
+// policy can SimSave() state and step copies ahead, see SimSnapshot.
+typedef bool (*EvalPolicy)(void *user, int episode, const SimState *state);
+
+typedef struct {
+  uint32_t score;
+  uint32_t ticks; // Ticks survived after the start
+} EvalResult;
+
+typedef struct {
+  int episodes;
+  uint64_t totalScore;
+  uint64_t totalTicks;
+  uint32_t bestScore;
+  uint32_t longestTicks;
+  int best; // Episode with bestScore, the lowest index on a tie
+  uint64_t steals;
+} EvalSummary;
+
+typedef struct Evaluator Evaluator;
+
+// One per thread, on its own cache line so the range CAS of one worker
+// never invalidates another's. The summary has a line of its own too, the
+// owner adds to it after every episode while thieves CAS range.
+typedef struct {
+  _Alignas(64) atomic_uint_fast64_t range; // begin << 32 | end
+  Evaluator *eval;
+  int self;
+  _Alignas(64) EvalSummary summary;
+} EvalWorker;
+
+struct Evaluator {
+  EvalWorker workers[EVAL_MAX_THREADS];
+  int workerCount; // The thread calling EvalRun() is worker 0
+  pthread_t threads[EVAL_MAX_THREADS];
+
+  // Generation handoff, only taken at the start and end of EvalRun()
+  pthread_mutex_t lock;
+  pthread_cond_t started;
+  pthread_cond_t finished;
+  uint64_t generation;
+  int running; // Pool threads still working on this generation
+  bool quit;
+
+  // The current generation, set before the threads are woken
+  EvalPolicy policy;
+  void *user;
+  uint64_t seed;
+  uint32_t maxTicks;
+  const CollisionMasks *masks;
+  EvalResult *results;
+};
+
+// threads 0 uses every core. Returns false if the pool cannot be set up.
+bool EvalInit(Evaluator *eval, int threads);
+void EvalFree(Evaluator *eval);
+
+// Plays episodes birds through the pipe level of seed, each for at most
+// maxTicks after the start. results receives one entry per episode, masks
+// may be NULL as in SimState. Blocks until the generation is done.
+EvalSummary EvalRun(Evaluator *eval, int episodes, uint64_t seed,
+                    uint32_t maxTicks, const CollisionMasks *masks,
+                    EvalPolicy policy, void *user, EvalResult *results);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+// Number type of the bird state. Floats by default. make FIXED_POINT=1
+// defines SIM_FIXED_POINT and keeps it in 24.8 fixed point integers instead,
+// so a trajectory comes out bit for bit the same on x86, ARM and WASM
+// whatever the compiler does with floats: FMA contraction, excess precision
+// and -ffast-math only reach what is drawn. Pipes stay floats holding exact
+// 24.8 values there, see pipes.c. Outside the sim, SimFloat() reads a
+// SimValue and SimFromFloat() places one.
+
+#include "config.h"
+
+#include <stdint.h>
+
+#ifdef SIM_FIXED_POINT
+
+typedef int32_t SimValue;
+
+#define SIM_NUMBERS "fixed"
+#define SIM_FIXED_BITS 8
+#define SIM_FIXED_ONE (1 << SIM_FIXED_BITS)
+
+// Constants only, rounded to nearest when compiled
+#define SIM_VALUE(value)                                                      \
+  ((SimValue)((value) * (double)SIM_FIXED_ONE + ((value) < 0 ? -0.5 : 0.5)))
+
+// v * SIM_DT and v * (1 - VELOCITY_DAMPING) as (v * K) >> bits. Clamped
+// velocities stay below 2^19, so the products fit in 32 bits and the SIMD
+// kernels keep 32-bit lanes. >> of a negative value is arithmetic on every
+// compiler the game builds with.
+#define SIM_FIXED_DT_BITS 19
+#define SIM_FIXED_DT                                                          \
+  ((int32_t)((1 << SIM_FIXED_DT_BITS) / (double)SIM_HZ + 0.5))
+#define SIM_FIXED_DRAG_BITS 20
+#define SIM_FIXED_DRAG                                                        \
+  ((int32_t)((1.0 - VELOCITY_DAMPING) * (1 << SIM_FIXED_DRAG_BITS) + 0.5))
+
+// Exact, every SimValue the sim produces is below 2^24
+static inline float SimFloat(SimValue value) {
+  return (float)value * (1.0f / SIM_FIXED_ONE);
+}
+
+// Nearest SimValue, exact for anything SimFloat() returned
+static inline SimValue SimFromFloat(float value) {
+  return (SimValue)(value * SIM_FIXED_ONE + (value < 0 ? -0.5f : 0.5f));
+}
+
+#else
+
+typedef float SimValue;
+
+#define SIM_NUMBERS "float"
+#define SIM_VALUE(value) ((SimValue)(value))
+
+static inline float SimFloat(SimValue value) { return value; }
+static inline SimValue SimFromFloat(float value) { return value; }
+
+#endif
+
+#endif
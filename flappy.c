@@ -0,0 +1,167 @@
+#include "flappy.h"
+#include "batch.h"
+#include "collision.h"
+#include "config.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct FlappyEnv {
+  BatchWorld world;
+  uint8_t *dead; // Agents whose death was already reported
+  float *observations;
+  float *rewards;
+  uint8_t *done;
+};
+
+FlappyEnv *FlappyCreate(int count, uint64_t seed) {
+  if (count <= 0) {
+    return NULL;
+  }
+
+  FlappyEnv *env = calloc(1, sizeof(FlappyEnv));
+  if (env == NULL) {
+    return NULL;
+  }
+  env->dead = calloc((size_t)count, 1);
+  if (env->dead == NULL || !BatchInit(&env->world, count, seed)) {
+    free(env->dead);
+    free(env);
+    return NULL;
+  }
+  return env;
+}
+
+void FlappyDestroy(FlappyEnv *env) {
+  if (env == NULL) {
+    return;
+  }
+  BatchFree(&env->world);
+  free(env->dead);
+  free(env);
+}
+
+int FlappyCount(const FlappyEnv *env) {
+  assert(env != NULL);
+
+  return env->world.count;
+}
+
+static void Observe(FlappyEnv *env) {
+  const BatchWorld *world = &env->world;
+  // Every agent sits at BIRD_START_X, so they all face the same pipe
+  const Pipe *pipe =
+      PipeRingAhead(&world->pipes, BIRD_START_X - BIRD_RADIUS * SCALE);
+  float dx = pipe->x - BIRD_START_X;
+
+  float *out = env->observations;
+  for (int i = 0; i < world->count; i++) {
+    out[FLAPPY_OBS_Y] = SimFloat(world->y[i]);
+    out[FLAPPY_OBS_VELOCITY] = SimFloat(world->velocityY[i]);
+    out[FLAPPY_OBS_PIPE_DX] = dx;
+    out[FLAPPY_OBS_PIPE_GAP_Y] = pipe->gapY;
+    out += FLAPPY_OBSERVATION_SIZE;
+  }
+}
+
+void FlappySetBuffers(FlappyEnv *env, float *observations, float *rewards,
+                      uint8_t *done) {
+  assert(env != NULL);
+  assert(observations != NULL && rewards != NULL && done != NULL);
+
+  env->observations = observations;
+  env->rewards = rewards;
+  env->done = done;
+
+  for (int i = 0; i < env->world.count; i++) {
+    rewards[i] = 0;
+    done[i] = env->dead[i];
+  }
+  Observe(env);
+}
+
+int FlappyStep(FlappyEnv *env, const uint8_t *actions, int count) {
+  assert(env != NULL);
+  assert(actions != NULL);
+
+  BatchWorld *world = &env->world;
+  if (count != world->count || env->observations == NULL) {
+    return -1;
+  }
+
+  BatchStep(world, actions);
+  // BatchStep() scored this pass for every bird still alive
+  bool passed = PipeRingPassed(&world->pipes, BIRD_START_X);
+
+  for (int i = 0; i < count; i++) {
+    float reward = 0;
+    if (world->alive[i] != 0) {
+      reward = passed ? 1.0f : 0.0f;
+    } else if (!env->dead[i]) {
+      reward = -1.0f;
+      env->dead[i] = 1;
+    }
+    env->rewards[i] = reward;
+    env->done[i] = env->dead[i];
+  }
+  Observe(env);
+  return 0;
+}
+
+void FlappyReset(FlappyEnv *env, const uint8_t *mask) {
+  assert(env != NULL);
+
+  BatchWorld *world = &env->world;
+  if (mask == NULL) {
+    BatchReset(world);
+  }
+  for (int i = 0; i < world->count; i++) {
+    if (mask == NULL || mask[i] != 0) {
+      if (mask != NULL) {
+        BatchRespawn(world, i);
+      }
+      env->dead[i] = 0;
+      if (env->done != NULL) {
+        env->rewards[i] = 0;
+        env->done[i] = 0;
+      }
+    }
+  }
+  if (env->observations != NULL) {
+    Observe(env);
+  }
+}
+
+size_t FlappySnapshotSize(const FlappyEnv *env) {
+  assert(env != NULL);
+
+  return BatchSnapshotSize(&env->world) + (size_t)env->world.count;
+}
+
+void FlappySave(const FlappyEnv *env, void *snapshot) {
+  assert(env != NULL);
+  assert(snapshot != NULL);
+
+  BatchSave(&env->world, snapshot);
+  memcpy((unsigned char *)snapshot + BatchSnapshotSize(&env->world),
+         env->dead, (size_t)env->world.count);
+}
+
+void FlappyRestore(FlappyEnv *env, const void *snapshot) {
+  assert(env != NULL);
+  assert(snapshot != NULL);
+
+  BatchRestore(&env->world, snapshot);
+  memcpy(env->dead,
+         (const unsigned char *)snapshot + BatchSnapshotSize(&env->world),
+         (size_t)env->world.count);
+  if (env->observations != NULL) {
+    for (int i = 0; i < env->world.count; i++) {
+      env->rewards[i] = 0;
+      env->done[i] = env->dead[i];
+    }
+    Observe(env);
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef FLAPPY_H
+#define FLAPPY_H
+
+// Batch step API for training bots, built as libflappy.so by make
+// libflappy.so. Wraps the BatchWorld in batch.h, so every agent runs the
+// same physics as the game. The caller owns every buffer: observations,
+// rewards and done flags are written straight into them on each step and
+// nothing is allocated or copied per step.
+//
+// All agents share one pipe stream, see batch.h.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define FLAPPY_API __declspec(dllexport)
+#else
+#define FLAPPY_API __attribute__((visibility("default")))
+#endif
+
+// Floats per agent in the observation buffer, in this order
+enum {
+  FLAPPY_OBS_Y,          // Bird center, screen pixels from the top
+  FLAPPY_OBS_VELOCITY,   // Pixels per second, positive is down
+  FLAPPY_OBS_PIPE_DX,    // Next pipe's left edge minus the bird's x
+  FLAPPY_OBS_PIPE_GAP_Y, // Next pipe's gap center
+  FLAPPY_OBSERVATION_SIZE
+};
+
+typedef struct FlappyEnv FlappyEnv;
+
+// NULL when count is not positive or out of memory
+FLAPPY_API FlappyEnv *FlappyCreate(int count, uint64_t seed);
+FLAPPY_API void FlappyDestroy(FlappyEnv *env);
+
+FLAPPY_API int FlappyCount(const FlappyEnv *env);
+
+// observations holds count * FLAPPY_OBSERVATION_SIZE floats, rewards count
+// floats and done count bytes. They stay in use until the next call and
+// are filled right away with the current state.
+FLAPPY_API void FlappySetBuffers(FlappyEnv *env, float *observations,
+                                 float *rewards, uint8_t *done);
+
+// One sim tick. actions holds count bytes, non-zero flaps. Rewards are +1
+// for passing a pipe, -1 on the tick an agent dies and 0 otherwise. A done
+// agent stays in place with zero reward until it is reset. Returns -1 when
+// count does not match or no buffers are set, 0 otherwise.
+FLAPPY_API int FlappyStep(FlappyEnv *env, const uint8_t *actions, int count);
+
+// Restarts the agents whose mask byte is non-zero, in the current pipe
+// stream. A NULL mask restarts every agent and the pipes with them.
+FLAPPY_API void FlappyReset(FlappyEnv *env, const uint8_t *mask);
+
+// Fork and rewind for search. FlappySave() copies the whole env state into
+// a caller buffer of FlappySnapshotSize() bytes, FlappyRestore() puts it
+// back, with zero rewards and the observations and done flags of then. A
+// snapshot only fits envs with the same count.
+FLAPPY_API size_t FlappySnapshotSize(const FlappyEnv *env);
+FLAPPY_API void FlappySave(const FlappyEnv *env, void *snapshot);
+FLAPPY_API void FlappyRestore(FlappyEnv *env, const void *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,145 @@
+#include "ghost.h"
+#include "config.h"
+
+#include "rlgl.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define GHOST_DEG2RAD (3.14159265358979f / 180.0f)
+
+bool GhostBatchInit(GhostBatch *batch, int capacity) {
+  assert(batch != NULL);
+  assert(capacity > 0);
+
+  // One block, the float fields first so they stay aligned
+  size_t n = (size_t)capacity;
+  unsigned char *block =
+      malloc(n * (5 * sizeof(float) + sizeof(Color) + sizeof(uint8_t)));
+  if (block == NULL) {
+    return false;
+  }
+
+  *batch = (GhostBatch){.capacity = capacity,
+                        .count = 0,
+                        .tick = 0,
+                        .x = (float *)block,
+                        .y = (float *)block + n,
+                        .cos = (float *)block + n * 2,
+                        .sin = (float *)block + n * 3,
+                        .angle = (float *)block + n * 4,
+                        .tint = (Color *)(block + n * 5 * sizeof(float))};
+  batch->frame = (uint8_t *)(batch->tint + n);
+  for (int i = 0; i < capacity; i++) {
+    batch->angle[i] = 0.0f;
+  }
+  return true;
+}
+
+void GhostBatchFree(GhostBatch *batch) {
+  assert(batch != NULL);
+
+  free(batch->x);
+  *batch = (GhostBatch){0};
+}
+
+void GhostBatchFromWorld(GhostBatch *batch, const BatchWorld *world,
+                         float alpha, unsigned char opacity) {
+  assert(batch != NULL);
+  assert(world != NULL);
+  assert(world->count <= batch->capacity);
+
+  // The world went back to the start, so do the angles, like SimRestore()
+  if (world->tick < batch->tick) {
+    for (int i = 0; i < world->count; i++) {
+      batch->angle[i] = 0.0f;
+    }
+  }
+  batch->tick = world->tick;
+
+  int count = 0;
+  for (int i = 0; i < world->count; i++) {
+    if (world->alive[i] == 0) {
+      continue;
+    }
+
+    // Change angle only if bird is moving else use old angle
+    float velocityY = SimFloat(world->velocityY[i]);
+    if (velocityY != 0) {
+      batch->angle[i] = (velocityY - MIN_VELOCITY) /
+                            (float)(MAX_VELOCITY - MIN_VELOCITY) * 120.0f -
+                        30.0f;
+    }
+    float previous = SimFloat(world->previousY[i]);
+    float angle = batch->angle[i] * GHOST_DEG2RAD;
+
+    batch->x[count] = BIRD_START_X;
+    batch->y[count] = previous + (SimFloat(world->y[i]) - previous) * alpha;
+    batch->cos[count] = cosf(angle);
+    batch->sin[count] = sinf(angle);
+    batch->frame[count] =
+        (uint8_t)((world->tick / BIRD_FRAME_TICKS + (uint64_t)i) %
+                  BIRD_FRAMES);
+    batch->tint[count] = SkinTint((Skin)(i % SKIN_COUNT), opacity);
+    count++;
+  }
+  batch->count = count;
+}
+
+void DrawGhostBatch(const GhostBatch *batch, const BirdSkins *skins) {
+  assert(batch != NULL);
+  assert(skins != NULL);
+
+  // Texture coordinates and half extents of every frame, shared by all
+  // instances
+  const Texture2D *texture = &skins->indices;
+  float u0[BIRD_FRAMES], v0[BIRD_FRAMES], u1[BIRD_FRAMES], v1[BIRD_FRAMES];
+  float halfW[BIRD_FRAMES], halfH[BIRD_FRAMES];
+  for (int f = 0; f < BIRD_FRAMES; f++) {
+    Rectangle r = skins->rects[f];
+    u0[f] = r.x / texture->width;
+    v0[f] = r.y / texture->height;
+    u1[f] = (r.x + r.width) / texture->width;
+    v1[f] = (r.y + r.height) / texture->height;
+    halfW[f] = r.width * SCALE / 2.0f;
+    halfH[f] = r.height * SCALE / 2.0f;
+  }
+
+  rlSetTexture(texture->id);
+  for (int start = 0; start < batch->count; start += GHOST_CHUNK) {
+    int end = start + GHOST_CHUNK;
+    end = end > batch->count ? batch->count : end;
+
+    // A flush draws the batch with the palettes and drops them
+    if (rlCheckRenderBatchLimit(4 * (end - start))) {
+      BindSkinPalettes(skins);
+    }
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (int i = start; i < end; i++) {
+      int f = batch->frame[i];
+      float c = batch->cos[i];
+      float s = batch->sin[i];
+      // Corner offsets rotated about the center, same as DrawTexturePro()
+      // with the origin in the middle
+      float ax = halfW[f] * c, ay = halfW[f] * s;
+      float bx = halfH[f] * s, by = halfH[f] * c;
+      float x = batch->x[i];
+      float y = batch->y[i];
+
+      Color tint = batch->tint[i];
+      rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+      rlTexCoord2f(u0[f], v0[f]);
+      rlVertex2f(x - ax + bx, y - ay - by);
+      rlTexCoord2f(u0[f], v1[f]);
+      rlVertex2f(x - ax - bx, y - ay + by);
+      rlTexCoord2f(u1[f], v1[f]);
+      rlVertex2f(x + ax - bx, y + ay + by);
+      rlTexCoord2f(u1[f], v0[f]);
+      rlVertex2f(x + ax + bx, y + ay - by);
+    }
+    rlEnd();
+  }
+  rlSetTexture(0);
+}
@@ -0,0 +1,47 @@
+#ifndef GHOST_H
+#define GHOST_H
+
+// Ghost birds for spectating batches and ghost races. Instances are kept as
+// arrays per field and drawn as textured quads straight into raylib's sprite
+// batch under one texture bind, instead of one DrawTexturePro() per bird.
+// Every skin shares that bind, see skins.h.
+
+#include "batch.h"
+#include "raylib.h"
+#include "skins.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Quads handed to rlgl per rlBegin()/rlEnd(), well below its batch size
+#define GHOST_CHUNK 1024
+
+typedef struct {
+  int capacity;
+  int count;
+  uint64_t tick; // World tick of the last fill
+  // Per instance: center, rotation as cos/sin, flap frame and SkinTint()
+  float *x;
+  float *y;
+  float *cos;
+  float *sin;
+  uint8_t *frame;
+  Color *tint;
+  // Per world bird: rotation in degrees, kept while it does not move
+  float *angle;
+} GhostBatch;
+
+bool GhostBatchInit(GhostBatch *batch, int capacity);
+void GhostBatchFree(GhostBatch *batch);
+
+// Fills the batch with the live birds of world in one pass: position
+// interpolated by alpha, rotation from velocity like SimStepBird() and the
+// flap frame from the world tick, offset per bird so they do not all flap
+// together, and the skins taking turns. Dead birds are left out.
+void GhostBatchFromWorld(GhostBatch *batch, const BatchWorld *world,
+                         float alpha, unsigned char opacity);
+
+// Call between BeginSkins() and EndSkins()
+void DrawGhostBatch(const GhostBatch *batch, const BirdSkins *skins);
+
+#endif
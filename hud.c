@@ -0,0 +1,122 @@
+#include "hud.h"
+#include "config.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+bool LoadScoreDisplay(ScoreDisplay *display, const Atlas *atlas) {
+  assert(display != NULL);
+  assert(atlas != NULL);
+
+  float width = 0;
+  float height = 0;
+  for (int d = 0; d <= 9; d++) {
+    Rectangle rect = atlas->rects[SPRITE_DIGIT_0 + d];
+    width = rect.width > width ? rect.width : width;
+    height = rect.height > height ? rect.height : height;
+  }
+
+  *display = (ScoreDisplay){.atlas = atlas, .valid = false};
+  display->target = LoadRenderTexture(
+      (int)(width * SCALE * SCORE_MAX_DIGITS), (int)(height * SCALE));
+  return IsRenderTextureValid(display->target);
+}
+
+void UnloadScoreDisplay(ScoreDisplay *display) {
+  assert(display != NULL);
+
+  UnloadRenderTexture(display->target);
+}
+
+static void RebuildScore(ScoreDisplay *display, uint32_t score) {
+  const Atlas *atlas = display->atlas;
+
+  Sprite digits[SCORE_MAX_DIGITS];
+  int count = 0;
+  do {
+    digits[count++] = SPRITE_DIGIT_0 + score % 10;
+    score /= 10;
+  } while (score != 0);
+
+  // Only called between frames or from the UI pass, never inside another
+  // texture mode
+  BeginTextureMode(display->target);
+  ClearBackground(BLANK);
+  float x = 0;
+  for (int i = count - 1; i >= 0; i--) {
+    Rectangle source = atlas->rects[digits[i]];
+    Rectangle dest = {x, 0, source.width * SCALE, source.height * SCALE};
+    DrawTexturePro(atlas->texture, source, dest, (Vector2){0, 0}, 0, WHITE);
+    x += dest.width;
+  }
+  EndTextureMode();
+
+  display->width = (int)x;
+}
+
+void DrawScoreDisplay(ScoreDisplay *display, uint32_t score, float centerX,
+                      float y) {
+  assert(display != NULL);
+
+  if (!display->valid || display->score != score) {
+    RebuildScore(display, score);
+    display->score = score;
+    display->valid = true;
+  }
+
+  // Render textures are stored bottom up, the flipped source reads the
+  // used strip at the top
+  Texture2D texture = display->target.texture;
+  Rectangle source = {0, 0, display->width, -texture.height};
+  Rectangle dest = {centerX - display->width / 2.0f, y, display->width,
+                    texture.height};
+  DrawTexturePro(texture, source, dest, (Vector2){0, 0}, 0, WHITE);
+}
+
+CachedText CreateCachedText(int fontSize, Color color) {
+  CachedText cache = {
+      .text = NULL, .fallback = false, .fontSize = fontSize, .color = color};
+  return cache;
+}
+
+void UnloadCachedText(CachedText *cache) {
+  assert(cache != NULL);
+
+  if (cache->text != NULL && !cache->fallback) {
+    UnloadRenderTexture(cache->target);
+  }
+  cache->text = NULL;
+  cache->fallback = false;
+}
+
+void DrawCachedText(CachedText *cache, const char *text, int x, int y) {
+  assert(cache != NULL);
+  assert(text != NULL);
+
+  if (cache->text != text) {
+    UnloadCachedText(cache);
+    int width = MeasureText(text, cache->fontSize);
+    cache->target = LoadRenderTexture(width > 0 ? width : 1, cache->fontSize);
+    cache->text = text;
+    // No texture to cache into, not retried until the text changes
+    cache->fallback = !IsRenderTextureValid(cache->target);
+    if (cache->fallback) {
+      TraceLog(LOG_WARNING, "Cannot cache text, drawing it every frame");
+    } else {
+      BeginTextureMode(cache->target);
+      ClearBackground(BLANK);
+      DrawText(text, 0, 0, cache->fontSize, cache->color);
+      EndTextureMode();
+    }
+  }
+
+  // The glyphs like before
+  if (cache->fallback) {
+    DrawText(text, x, y, cache->fontSize, cache->color);
+    return;
+  }
+  Texture2D texture = cache->target.texture;
+  DrawTextureRec(texture,
+                 (Rectangle){0, 0, texture.width, -texture.height},
+                 (Vector2){x, y}, WHITE);
+}
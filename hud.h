@@ -0,0 +1,48 @@
+#ifndef HUD_H
+#define HUD_H
+
+// Score and hint text, each drawn once into a small render texture and only
+// redrawn when what it shows changes. Every frame then costs one quad per
+// item instead of a glyph or sprite per character.
+
+#include "atlas.h"
+#include "raylib.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Enough digits for any uint32_t score
+#define SCORE_MAX_DIGITS 10
+
+typedef struct {
+  const Atlas *atlas;
+  RenderTexture2D target; // Room for SCORE_MAX_DIGITS of the widest digit
+  uint32_t score;         // What target shows
+  int width;              // Used part of target
+  bool valid;             // target holds score
+} ScoreDisplay;
+
+bool LoadScoreDisplay(ScoreDisplay *display, const Atlas *atlas);
+void UnloadScoreDisplay(ScoreDisplay *display);
+
+// Draws score from the digit sprites, centered on centerX. The texture is
+// rebuilt first if the score changed.
+void DrawScoreDisplay(ScoreDisplay *display, uint32_t score, float centerX,
+                      float y);
+
+typedef struct {
+  RenderTexture2D target;
+  const char *text; // What target shows, compared by pointer
+  bool fallback;    // target failed to load for text, drawn with DrawText()
+  int fontSize;
+  Color color;
+} CachedText;
+
+CachedText CreateCachedText(int fontSize, Color color);
+void UnloadCachedText(CachedText *cache);
+
+// text is expected to be a string literal or otherwise live as long as it
+// is shown, a different pointer rebuilds the texture
+void DrawCachedText(CachedText *cache, const char *text, int x, int y);
+
+#endif
@@ -0,0 +1,88 @@
+#include "input.h"
+#include "raylib.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+void InputInit(InputQueue *queue) {
+  assert(queue != NULL);
+
+  *queue = (InputQueue){.head = 0};
+}
+
+void InputLatch(InputQueue *queue, int key) {
+  assert(queue != NULL);
+  assert(queue->latchCount < INPUT_MAX_LATCHED);
+
+  queue->latchKeys[queue->latchCount] = key;
+  queue->latched[queue->latchCount] = false;
+  queue->latchCount++;
+}
+
+void InputSample(InputQueue *queue) {
+  assert(queue != NULL);
+
+  for (int i = 0; i < queue->latchCount; i++) {
+    queue->latched[i] |= IsKeyPressed(queue->latchKeys[i]);
+  }
+
+  SimInput input = {.start = IsKeyPressed(KEY_S),
+                    .jump = IsKeyPressed(KEY_SPACE)};
+  if (!input.start && !input.jump) {
+    return;
+  }
+  if (queue->count == INPUT_QUEUE_SIZE) {
+    queue->dropped++;
+    return;
+  }
+  int slot = (queue->head + queue->count) % INPUT_QUEUE_SIZE;
+  queue->events[slot] = (TimedInput){.time = GetTime(), .input = input};
+  queue->count++;
+}
+
+void InputWait(InputQueue *queue, double until, double slice, bool wake) {
+  assert(queue != NULL);
+  assert(slice > 0);
+
+  bool focused = IsWindowFocused();
+  for (double now = GetTime(); now < until; now = GetTime()) {
+    double left = until - now;
+    WaitTime(left < slice ? left : slice);
+    PollInputEvents();
+    InputSample(queue);
+    if (wake && (GetKeyPressed() != 0 || IsWindowFocused() != focused)) {
+      return;
+    }
+  }
+}
+
+SimInput InputTake(InputQueue *queue, double until) {
+  assert(queue != NULL);
+
+  SimInput input = {0};
+  while (queue->count > 0 && queue->events[queue->head].time <= until) {
+    const TimedInput *event = &queue->events[queue->head];
+    input.start |= event->input.start;
+    input.jump |= event->input.jump;
+    if (queue->applied == 0) {
+      queue->applied = event->time;
+    }
+    queue->head = (queue->head + 1) % INPUT_QUEUE_SIZE;
+    queue->count--;
+  }
+  return input;
+}
+
+bool InputLatched(InputQueue *queue, int key) {
+  assert(queue != NULL);
+
+  for (int i = 0; i < queue->latchCount; i++) {
+    if (queue->latchKeys[i] == key) {
+      bool pressed = queue->latched[i];
+      queue->latched[i] = false;
+      return pressed;
+    }
+  }
+  assert(false && "key is not latched");
+  return false;
+}
@@ -0,0 +1,59 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+// Timestamped keyboard input. raylib only reports key presses per poll, and
+// the stock loop polls once per frame, so a flap could wait most of a frame
+// before the sim saw it. Here the loop waits out its frame in short slices
+// that each poll and stamp new presses with GetTime(). Every fixed tick then
+// takes the presses that happened before the wall time it ends at, so a
+// press lands on the tick it happened in whatever the render rate.
+
+#include "sim.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define INPUT_QUEUE_SIZE 64
+// Longest sleep between two polls while waiting for the next frame, and
+// the coarser one for idle frames where a press may be stamped late
+#define INPUT_POLL_SLICE 0.001
+#define INPUT_IDLE_SLICE 0.01
+// Keys besides S and SPACE whose presses are kept until asked for
+#define INPUT_MAX_LATCHED 4
+
+typedef struct {
+  double time; // GetTime() of the poll that saw the press
+  SimInput input;
+} TimedInput;
+
+typedef struct {
+  TimedInput events[INPUT_QUEUE_SIZE]; // Oldest at head
+  int head;
+  int count;
+  uint32_t dropped; // Presses lost to a full queue
+
+  int latchKeys[INPUT_MAX_LATCHED];
+  bool latched[INPUT_MAX_LATCHED];
+  int latchCount;
+
+  double applied; // Stamp of the oldest press a tick took, 0 if none
+} InputQueue;
+
+void InputInit(InputQueue *queue);
+// Keeps presses of key for InputLatched(), e.g. overlay toggles
+void InputLatch(InputQueue *queue, int key);
+
+// Records the presses of the last poll, call after every PollInputEvents()
+// or EndDrawing()
+void InputSample(InputQueue *queue);
+// Polls and samples in slice steps until GetTime() reaches until. With wake,
+// any key press or a change of window focus ends the wait early, so long
+// idle frames still answer right away.
+void InputWait(InputQueue *queue, double until, double slice, bool wake);
+
+// Merges every press stamped at or before until into one tick's input
+SimInput InputTake(InputQueue *queue, double until);
+// True if key was pressed since the last call, key must be latched
+bool InputLatched(InputQueue *queue, int key);
+
+#endif
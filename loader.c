@@ -0,0 +1,126 @@
+#include "loader.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+void LoaderInit(Loader *loader) {
+  assert(loader != NULL);
+
+  loader->count = 0;
+  loader->threadCount = 0;
+  atomic_init(&loader->next, 0);
+  atomic_init(&loader->finished, 0);
+}
+
+static int Add(Loader *loader, LoadKind kind, const char *path) {
+  assert(loader != NULL);
+  assert(loader->count < LOADER_MAX_JOBS);
+  assert(loader->threadCount == 0); // Queue everything before starting
+
+  LoadJob *job = &loader->jobs[loader->count];
+  *job = (LoadJob){.kind = kind};
+  snprintf(job->path, sizeof(job->path), "%s", path);
+  return loader->count++;
+}
+
+int LoaderAddImage(Loader *loader, const char *path) {
+  return Add(loader, LOAD_IMAGE, path);
+}
+
+int LoaderAddWave(Loader *loader, const char *path) {
+  return Add(loader, LOAD_WAVE, path);
+}
+
+static void Decode(LoadJob *job) {
+  if (job->kind == LOAD_IMAGE) {
+    job->image = LoadImage(job->path);
+    job->ok = IsImageValid(job->image);
+    if (job->ok) {
+      ImageFormat(&job->image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+  } else {
+    job->wave = LoadWave(job->path);
+    job->ok = IsWaveValid(job->wave);
+  }
+}
+
+// Claims jobs until none are left, finished is bumped after the job is
+// written so the main thread sees complete results
+static void RunJobs(Loader *loader) {
+  for (;;) {
+    int i = atomic_fetch_add(&loader->next, 1);
+    if (i >= loader->count) {
+      return;
+    }
+    Decode(&loader->jobs[i]);
+    atomic_fetch_add(&loader->finished, 1);
+  }
+}
+
+static void *Worker(void *data) {
+  RunJobs(data);
+  return NULL;
+}
+
+void LoaderStart(Loader *loader) {
+  assert(loader != NULL);
+
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = cores < 1 ? 1 : (int)cores;
+  threads = threads > LOADER_MAX_THREADS ? LOADER_MAX_THREADS : threads;
+  threads = threads > loader->count ? loader->count : threads;
+
+  for (int i = 0; i < threads; i++) {
+    if (pthread_create(&loader->threads[loader->threadCount], NULL, Worker,
+                       loader) == 0) {
+      loader->threadCount++;
+    }
+  }
+}
+
+bool LoaderFinish(Loader *loader) {
+  assert(loader != NULL);
+
+  RunJobs(loader); // Whatever no worker picked up, if none started
+  for (int i = 0; i < loader->threadCount; i++) {
+    pthread_join(loader->threads[i], NULL);
+  }
+  loader->threadCount = 0;
+
+  char failed[512] = "";
+  int failures = 0;
+  int required = 0;
+  for (int i = 0; i < loader->count; i++) {
+    if (!loader->jobs[i].ok) {
+      size_t used = strlen(failed);
+      snprintf(failed + used, sizeof(failed) - used, " %s",
+               loader->jobs[i].path);
+      failures++;
+      required += !loader->jobs[i].optional;
+    }
+  }
+  if (failures == 0) {
+    return true;
+  }
+  if (required == 0) {
+    TraceLog(LOG_WARNING, "Failed to load %d optional assets:%s", failures,
+             failed);
+    return true;
+  }
+
+  TraceLog(LOG_ERROR, "Failed to load %d of %d assets:%s", failures,
+           loader->count, failed);
+  for (int i = 0; i < loader->count; i++) {
+    if (loader->jobs[i].ok) {
+      if (loader->jobs[i].kind == LOAD_IMAGE) {
+        UnloadImage(loader->jobs[i].image);
+      } else {
+        UnloadWave(loader->jobs[i].wave);
+      }
+      loader->jobs[i].ok = false;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,62 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+// Decodes images and sounds on a few worker threads. The main thread queues
+// files, keeps drawing a loading frame while LoaderDone() is false, then
+// takes the decoded buffers and uploads them. Anything touching the GPU or
+// the audio device stays on the main thread.
+
+#include "raylib.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#define LOADER_MAX_JOBS 64
+#define LOADER_MAX_THREADS 4
+#define LOADER_PATH_LENGTH 256
+
+typedef enum { LOAD_IMAGE, LOAD_WAVE } LoadKind;
+
+typedef struct {
+  LoadKind kind;
+  char path[LOADER_PATH_LENGTH];
+  bool optional; // Failing does not fail LoaderFinish()
+  bool ok;
+  Image image; // RGBA8, for LOAD_IMAGE
+  Wave wave;   // For LOAD_WAVE
+} LoadJob;
+
+typedef struct {
+  LoadJob jobs[LOADER_MAX_JOBS];
+  int count;
+
+  pthread_t threads[LOADER_MAX_THREADS];
+  int threadCount;
+  atomic_int next;     // Next job a worker claims
+  atomic_int finished; // Jobs decoded so far
+} Loader;
+
+void LoaderInit(Loader *loader);
+
+// Return the job index, where the result shows up after LoaderFinish()
+int LoaderAddImage(Loader *loader, const char *path);
+int LoaderAddWave(Loader *loader, const char *path);
+
+// Starts the workers. If no thread can be started the jobs run in
+// LoaderFinish() instead.
+void LoaderStart(Loader *loader);
+
+static inline int LoaderProgress(const Loader *loader) {
+  return atomic_load(&loader->finished);
+}
+static inline bool LoaderDone(const Loader *loader) {
+  return LoaderProgress(loader) == loader->count;
+}
+
+// Waits for the workers. Returns false if any file that is not optional
+// failed, after logging all of them in one message and freeing everything
+// that did decode. Failed optional jobs are only logged and left !ok.
+bool LoaderFinish(Loader *loader);
+
+#endif
@@ -1,258 +1,970 @@
+#include "assets.h"
+#include "atlas.h"
+#include "audio.h"
+#include "capture.h"
+#include "collision.h"
+#include "entity.h"
+#include "ghost.h"
+#include "hud.h"
+#include "input.h"
+#include "loader.h"
+#include "particle.h"
+#include "prof.h"
 #include "raylib.h"
-#include "raymath.h"
+#include "render.h"
+#include "replay.h"
+#include "sim.h"
+#include "skins.h"
+#include "telemetry.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ASSET_PACK "./assets.pak"
+
+// Longest frame we try to catch up on, anything above is dropped
+#define MAX_FRAME_TIME 0.25f
+
+// --fast-forward runs the sim flat out and only draws at this rate
+#define FAST_FORWARD_AUTO -1
+#define FAST_FORWARD_HZ 30
+// Ticks between input polls while fast forwarding between two frames
+#define FAST_FORWARD_POLL_TICKS 256
+
+// Frame rates the loop paces itself to, see InputWait(). Nothing moves but
+// the background on the title and game over screens, and nobody watches an
+// unfocused or minimized window closely, so those frames come less often.
+#define TARGET_FPS 60
+#define IDLE_FPS 20
+#define BACKGROUND_FPS 10
+#define MINIMIZED_FPS 4
+
+// The wrapped layers are uploaded before the atlas, so a failure here has
+// nothing else to undo
+bool CheckLayers(Texture2D *layers) {
+  if (IsTextureValid(layers[0]) && IsTextureValid(layers[1])) {
+    return true;
+  }
 
-#define SCREEN_HEIGHT 768
-#define SCREEN_WIDTH 1300
-
-#define SCALE 1.5f
-
-#define MAX_VELOCITY 800
-#define MIN_VELOCITY -400
-
-#define BG_SPEED 40.0f
-#define BG_POS_Y 0
-#define BASE_SPEED BG_SPEED * 3
-#define BASE_POS_Y 600
+  TraceLog(LOG_ERROR, "Failed to upload the wrapped background textures");
+  UnloadTexture(layers[0]);
+  UnloadTexture(layers[1]);
+  return false;
+}
 
-#define PIPE_GAP 300
-#define PIPE_SPACING 250
+// Startup loading from the baked pack, nothing is decoded but the atlas
+// pixels for the masks. layers receives the background and base textures for
+// --wrap-background, image and skinImage the atlas and bird pixels for the
+// collision masks, see LoadSkinsFromImages(). layers may be NULL, and image
+// and skinImage together. Missing sound only leaves the game silent.
+bool LoadPackedAssets(const Pack *pack, Atlas *atlas, BirdSkins *skins,
+                      Texture2D *layers, Image *image, Image *skinImage,
+                      Audio *audio) {
+  if (layers != NULL) {
+    layers[0] = LoadPackTexture(pack, "background-day");
+    layers[1] = LoadPackTexture(pack, "base");
+    if (!CheckLayers(layers)) {
+      return false;
+    }
+  }
 
-typedef struct {
-  Vector2 position;
-  Vector2 velocity;
-  float radius;
-  Texture2D *textures;
-  int textureLength;
-
-  int currentFrame;
-  float frameTimer;
-  float frameDuration;
-  float angle;
-} Bird;
-
-Bird CreateBird(Texture2D *textures, size_t length) {
-  assert(textures != NULL);
-
-  Bird bird = {.position = {100, SCREEN_HEIGHT / 2.0f},
-               .velocity = {0, 0},
-               .radius = (float)textures[0].width / 2,
-               .textures = textures,
-               .textureLength = length,
-
-               .currentFrame = 0,  // Start at the first frame
-               .frameTimer = 0.0f, // Reset timer
-               .frameDuration = 1.0f / 8.0f,
-               .angle = 0};
-
-  return bird;
+  if (!LoadSkinsFromPack(skins, pack, skinImage)) {
+    if (layers != NULL) {
+      UnloadTexture(layers[0]);
+      UnloadTexture(layers[1]);
+    }
+    return false;
+  }
+  if (!LoadAtlasFromPack(atlas, pack, image)) {
+    if (skinImage != NULL) {
+      UnloadImage(*skinImage);
+    }
+    UnloadSkins(skins);
+    if (layers != NULL) {
+      UnloadTexture(layers[0]);
+      UnloadTexture(layers[1]);
+    }
+    return false;
+  }
+  LoadAudioFromPack(audio, pack);
+  return true;
 }
 
-void DestroyBird(Bird *bird) {
-  assert(bird != NULL);
+// Builds the pixel collision masks from the atlas and bird pixels, only
+// needed with --pixel-collision. Every skin has the same shapes.
+bool LoadCollisionMasks(CollisionMasks *masks, const Atlas *atlas,
+                        Image image, const BirdSkins *skins, Image skinImage,
+                        Sprite pipe) {
+  assert(masks != NULL);
+  assert(atlas != NULL);
+  assert(skins != NULL);
+
+  for (int i = 0; i < BIRD_FRAMES; i++) {
+    Rectangle rect = skins->rects[i];
+    const unsigned char *pixels =
+        (const unsigned char *)skinImage.data +
+        ((size_t)rect.y * skinImage.width + (size_t)rect.x) * 4;
+    if (!MaskBuildBird(masks, i, pixels, rect.width, rect.height,
+                       skinImage.width)) {
+      TraceLog(LOG_ERROR, "Failed to build collision mask for bird frame %d",
+               i);
+      return false;
+    }
+  }
 
-  for (int i = 0; i < bird->textureLength; i++) {
-    UnloadTexture(bird->textures[i]);
+  Rectangle rect = atlas->rects[pipe];
+  if (!MaskBuildPipe(masks, AtlasPixels(atlas, image, pipe), rect.width,
+                     rect.height, image.width)) {
+    TraceLog(LOG_ERROR, "Failed to build collision mask for %s",
+             AtlasSpriteName(pipe));
+    return false;
   }
+  return true;
 }
 
-void DrawBird(Bird *bird, float dt) {
-  assert(bird != NULL);
+// Startup loading without a pack. The PNGs and WAVs decode on worker threads
+// while this keeps drawing a loading frame, then everything is uploaded here.
+// layers, image and skinImage may be NULL, see LoadPackedAssets().
+bool LoadAssetsAsync(Atlas *atlas, BirdSkins *skins, Texture2D *layers,
+                     Image *image, Image *skinImage, Audio *audio) {
+  static Loader loader;
+  LoaderInit(&loader);
+  for (int i = 0; i < SPRITE_COUNT; i++) {
+    LoaderAddImage(&loader, TextFormat("./assets/sprites/%s.png",
+                                       AtlasSpriteName(i)));
+  }
+  // Waves come after the images, job SPRITE_COUNT + effect. Without them
+  // the game is only silent.
+  for (int i = 0; i < SOUND_COUNT; i++) {
+    int job = LoaderAddWave(&loader, TextFormat("./assets/audio/%s.wav",
+                                                AudioSoundName(i)));
+    loader.jobs[job].optional = true;
+  }
+  LoaderStart(&loader);
+
+  // Without a worker nothing runs before LoaderFinish(), so nothing to wait
+  // for here
+  bool closed = false;
+  while (loader.threadCount > 0 && !LoaderDone(&loader)) {
+    if (WindowShouldClose()) {
+      closed = true;
+      break;
+    }
+    BeginDrawing();
+    ClearBackground(BLACK);
+    DrawText(TextFormat("Loading %d/%d", LoaderProgress(&loader),
+                        loader.count),
+             10, 10, 20, DARKGRAY);
+    EndDrawing();
+  }
 
-  bird->frameTimer += dt; // Accumulate time
+  // All failures come back as one report
+  if (!LoaderFinish(&loader)) {
+    return false;
+  }
 
-  // Check if it's time to advance the frame
-  if (bird->frameTimer >= bird->frameDuration) {
-    bird->frameTimer -= bird->frameDuration; // Reset timer (subtracting is
-                                             // often better than setting to 0)
-    bird->currentFrame++;                    // Move to the next frame
+  Image images[SPRITE_COUNT];
+  for (int i = 0; i < SPRITE_COUNT; i++) {
+    images[i] = loader.jobs[i].image;
+  }
+  // The mixer keeps its own copy of the samples
+  Wave waves[SOUND_COUNT];
+  bool wavesOk = true;
+  for (int i = 0; i < SOUND_COUNT; i++) {
+    waves[i] = loader.jobs[SPRITE_COUNT + i].wave;
+    wavesOk &= loader.jobs[SPRITE_COUNT + i].ok;
+  }
+  *audio = (Audio){.ready = false};
+  if (!closed && wavesOk) {
+    LoadAudioFromWaves(audio, waves);
+  }
+  for (int i = 0; i < SOUND_COUNT; i++) {
+    if (loader.jobs[SPRITE_COUNT + i].ok) {
+      UnloadWave(waves[i]);
+    }
+  }
 
-    // Wrap the frame index back to 0 if it goes past the last frame
-    if (bird->currentFrame >= bird->textureLength) {
-      bird->currentFrame = 0;
+  bool ok = !closed;
+  // The scrolling layers and the skins get their own copy before the images
+  // are packed
+  if (ok && layers != NULL) {
+    layers[0] = LoadTextureFromImage(images[SPRITE_BACKGROUND_DAY]);
+    layers[1] = LoadTextureFromImage(images[SPRITE_BASE]);
+    ok = CheckLayers(layers);
+  }
+  if (ok && !LoadSkinsFromImages(skins, images, skinImage)) {
+    if (layers != NULL) {
+      UnloadTexture(layers[0]);
+      UnloadTexture(layers[1]);
+    }
+    ok = false;
+  }
+  if (!ok) {
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+      UnloadImage(images[i]);
     }
-    // A more concise way using modulo:
-    // bird->currentFrame = (bird->currentFrame + 1) % bird->textureLength;
+    UnloadAudio(audio);
+    return false;
   }
 
-  Texture2D currentTexture = bird->textures[bird->currentFrame];
+  if (!LoadAtlasFromImages(atlas, images, image)) {
+    if (skinImage != NULL) {
+      UnloadImage(*skinImage);
+    }
+    UnloadSkins(skins);
+    if (layers != NULL) {
+      UnloadTexture(layers[0]);
+      UnloadTexture(layers[1]);
+    }
+    UnloadAudio(audio);
+    return false;
+  }
+  return true;
+}
 
-  Rectangle source = {0, 0, currentTexture.width, currentTexture.height};
-  Rectangle dest = {bird->position.x, bird->position.y,
-                    currentTexture.width * SCALE,
-                    currentTexture.height * SCALE};
+// Where the sim input comes from and goes to
+typedef struct {
+  Replay *replay;
+  bool recording;
+  bool replaying;
+  bool checked; // The end of the replay was reported
+} Playback;
 
-  Vector2 origin = (Vector2){dest.width / 2.0, dest.height / 2.0};
+// Bot birds flying the player's level, drawn as one ghost batch
+typedef struct {
+  BatchWorld world;
+  uint8_t *jump;
+  GhostBatch batch;
+} Ghosts;
 
-  // Change angle only if bird is moving else use old angle
-  if (bird->velocity.y != 0) {
-    bird->angle = Remap(bird->velocity.y, MIN_VELOCITY, MAX_VELOCITY, -30, 90);
+#define GHOST_OPACITY 96
+
+// Feathers on every flap and debris on a crash. --particles sets the
+// capacity of each pool, 0 turns them off.
+#define PARTICLE_CAPACITY 512
+#define FEATHER_GRAVITY 240.0f
+#define DEBRIS_GRAVITY GRAVITY
+
+static const ParticleBurst featherBurst = {
+    .count = 6, .speed = 80.0f, .lift = 0.0f, .life = 0.6f, .frames = 3};
+static const ParticleBurst debrisBurst = {
+    .count = 24, .speed = 260.0f, .lift = 160.0f, .life = 1.2f, .frames = 3};
+
+typedef struct {
+  ParticlePool feathers; // Drawn from the skins, see BeginSkins()
+  ParticlePool debris;   // Drawn from the atlas
+  Rectangle featherFrames[3];
+  Rectangle debrisFrames[3];
+} Particles;
+
+// Flat colored 3x3 patches of the mid flap frame, the pipe and the base
+bool CreateParticles(Particles *particles, int capacity,
+                     const BirdSkins *skins, const Atlas *atlas,
+                     Sprite pipe) {
+  if (!ParticlesInit(&particles->feathers, capacity, FEATHER_GRAVITY)) {
+    return false;
+  }
+  if (!ParticlesInit(&particles->debris, capacity, DEBRIS_GRAVITY)) {
+    ParticlesFree(&particles->feathers);
+    return false;
   }
 
-  DrawTexturePro(currentTexture, source, dest, origin, bird->angle, WHITE);
-  DrawCircleV(bird->position, 2, WHITE);
+  Rectangle bird = skins->rects[1];
+  Rectangle pipeRect = atlas->rects[pipe];
+  Rectangle base = atlas->rects[SPRITE_BASE];
+  particles->featherFrames[0] = (Rectangle){bird.x + 12, bird.y + 4, 3, 3};
+  particles->featherFrames[1] = (Rectangle){bird.x + 12, bird.y + 16, 3, 3};
+  particles->featherFrames[2] = (Rectangle){bird.x + 20, bird.y + 2, 3, 3};
+  particles->debrisFrames[0] =
+      (Rectangle){pipeRect.x + 4, pipeRect.y + 100, 3, 3};
+  particles->debrisFrames[1] =
+      (Rectangle){pipeRect.x + 16, pipeRect.y + 100, 3, 3};
+  particles->debrisFrames[2] = (Rectangle){base.x + 8, base.y + 20, 3, 3};
+  return true;
 }
 
-typedef struct {
-  Texture2D texture;
-  float posX;
-  float posY;
-  float scrollSpeed;
-} ScrollingBackground;
-
-ScrollingBackground CreateScrollingBackground(Texture2D texture, float posY,
-                                              float speed) {
-
-  ScrollingBackground bg = {
-      .texture = texture, .posX = 0, .posY = posY, .scrollSpeed = speed};
-  return bg;
+void DestroyParticles(Particles *particles) {
+  ParticlesFree(&particles->feathers);
+  ParticlesFree(&particles->debris);
 }
 
-void DrawScrollingBackground(ScrollingBackground *bg, float dt) {
-  bg->posX -= bg->scrollSpeed * dt;
+// One burst per kind per frame, at the bird as the frame shows it
+void SpawnParticles(Particles *particles, uint32_t events,
+                    const SimBird *bird) {
+  if (events & SIM_EVENT_JUMP) {
+    ParticlesBurst(&particles->feathers, &featherBurst, bird->x,
+                   SimFloat(bird->y));
+  }
+  if (events & SIM_EVENT_DEATH) {
+    ParticlesBurst(&particles->debris, &debrisBurst, bird->x,
+                   SimFloat(bird->y));
+  }
+}
 
-  // Reset position when the first image is completely off-screen to the left
-  if (bg->posX <= -bg->texture.width * 1.5f) {
-    bg->posX = 0;
+// Entities of the game scene in draw order, the ghosts are drawn between
+// the pipes and the bird
+enum {
+  SCENE_BACKGROUND,
+  SCENE_PIPES, // PIPE_COUNT top and bottom halves
+  SCENE_BIRD = SCENE_PIPES + PIPE_COUNT * 2,
+  SCENE_BASE,
+  SCENE_COUNT
+};
+
+bool CreateGhosts(Ghosts *ghosts, int count, uint64_t seed) {
+  ghosts->jump = malloc((size_t)count);
+  if (ghosts->jump == NULL) {
+    return false;
   }
+  if (!BatchInit(&ghosts->world, count, seed)) {
+    free(ghosts->jump);
+    return false;
+  }
+  if (!GhostBatchInit(&ghosts->batch, count)) {
+    BatchFree(&ghosts->world);
+    free(ghosts->jump);
+    return false;
+  }
+  return true;
+}
 
-  Rectangle source = {0, 0, bg->texture.width, bg->texture.height};
+void DestroyGhosts(Ghosts *ghosts) {
+  GhostBatchFree(&ghosts->batch);
+  BatchFree(&ghosts->world);
+  free(ghosts->jump);
+}
 
-  int txH = bg->texture.height * SCALE;
-  int txW = bg->texture.width * SCALE;
-  int renderCount = 2 + SCREEN_WIDTH / txW;
-  if (txW > SCREEN_WIDTH) {
-    renderCount = 2 + txW / SCREEN_WIDTH;
+// Each ghost aims for its own height around the gap, so they spread out
+// and die one by one
+void StepGhosts(Ghosts *ghosts) {
+  BatchWorld *world = &ghosts->world;
+  const Pipe *pipe =
+      PipeRingAhead(&world->pipes, BIRD_START_X - BIRD_RADIUS * SCALE);
+  for (int i = 0; i < world->count; i++) {
+    float offset = (float)((uint32_t)i * 2654435761u % 121) - 60.0f;
+    ghosts->jump[i] = SimFloat(world->y[i]) > pipe->gapY + offset &&
+                      world->velocityY[i] > 0;
   }
+  BatchStep(world, ghosts->jump);
+}
 
-  for (int i = 0; i < renderCount; i++) {
-    Rectangle dest = {bg->posX + (i * dest.width), bg->posY, txW, txH};
+// Frames per second worth drawing right now
+int FrameRate(const SimState *sim) {
+  if (!IsWindowFocused()) {
+    return BACKGROUND_FPS;
+  }
+  return !sim->started || sim->dead ? IDLE_FPS : TARGET_FPS;
+}
 
-    DrawTexturePro(bg->texture, source, dest, (Vector2){0, 0}, 0, WHITE);
-    DrawRectangleV((Vector2){bg->posX + (i * dest.width), bg->posY},
-                   (Vector2){2, SCREEN_HEIGHT}, RED);
+// Back to the state before the first tick, textures and sounds stay loaded.
+// A recording starts over with the new run.
+void RestartRun(SimState *sim, const SimSnapshot *start, Playback *playback,
+                Ghosts *ghosts) {
+  SimRestore(sim, start);
+  if (ghosts != NULL) {
+    BatchReset(&ghosts->world);
+  }
+  if (playback->recording) {
+    ReplayHeader header = playback->replay->header;
+    ReplayFree(playback->replay);
+    ReplayInit(playback->replay, header.seed, header.flags);
   }
 }
 
-void DestroyAnimation(ScrollingBackground *b) {
-  assert(b != NULL);
-  UnloadTexture(b->texture);
+// One fixed tick ending at wall time tickEnd, with the presses queued up to
+// then. The input is recorded or replaced by the replay, which ignores the
+// keyboard. S after a game over restores start and starts right away.
+// Returns false without stepping once a replay reached its end, the sim then
+// holds the last recorded state. ghosts may be NULL, they move with the
+// pipes, so only while the player is alive.
+bool StepSim(SimState *sim, const SimSnapshot *start, InputQueue *queue,
+             double tickEnd, Playback *playback, Ghosts *ghosts) {
+  Replay *replay = playback->replay;
+  if (playback->replaying && sim->tick == replay->header.endTick) {
+    if (!playback->checked) {
+      bool matches = ReplayMatches(replay, sim);
+      TraceLog(matches ? LOG_INFO : LOG_WARNING, "Replay %s at tick %llu",
+               matches ? "matches the recording"
+                       : "DIFFERS from the recording",
+               (unsigned long long)sim->tick);
+      playback->checked = true;
+    }
+    return false;
+  }
+
+  SimInput input = InputTake(queue, tickEnd);
+  if (input.start && sim->dead && !playback->replaying) {
+    RestartRun(sim, start, playback, ghosts);
+  }
+  // S only starts and SPACE only flaps, other presses are dropped
+  input.start = input.start && !sim->started;
+  input.jump = input.jump && sim->started;
+  if (playback->replaying) {
+    input = ReplayInput(replay, sim->tick);
+  } else if (playback->recording &&
+             !ReplayRecord(replay, sim->tick, input)) {
+    TraceLog(LOG_ERROR, "Out of memory, recording stopped");
+    playback->recording = false;
+  }
+  SimStep(sim, input);
+  // Whenever the sim moved its pipes: the start tick too, and the death tick
+  if (ghosts != NULL && sim->started &&
+      (!sim->dead || (sim->events & SIM_EVENT_DEATH) != 0)) {
+    StepGhosts(ghosts);
+  }
+  return true;
 }
 
-int main(void) {
-  InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Flappy birds");
-  SetTargetFPS(60);
+// --replay --turbo: steps the whole run without drawing and reports whether
+// it still ends where the recording did
+int PlayTurbo(Replay *replay, const CollisionMasks *masks, const char *path) {
+  SimState sim;
+  bool matches = ReplayPlay(replay, masks, &sim);
+  printf("%s: %llu ticks, score %u, %s\n", path,
+         (unsigned long long)sim.tick, sim.score,
+         matches ? "matches the recording" : "DIFFERS from the recording");
+  ReplayFree(replay);
+  return matches ? 0 : 2;
+}
 
-  bool gameStarted = false;
+int main(int argc, char **argv) {
+  bool pixelCollision = false;
+  bool wrapBackground = false;
+  const char *recordPath = NULL;
+  const char *replayPath = NULL;
+  bool turbo = false;
+  int fastForward = 0; // Ticks per drawn frame, FAST_FORWARD_AUTO, or 0
+  int ghostCount = 0;
+  bool lowRes = false;
+  Skin skin = SKIN_BLUE;
+  int particleCapacity = PARTICLE_CAPACITY;
+  const char *telemetryPath = NULL;
+  const char *capturePath = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--pixel-collision") == 0) {
+      pixelCollision = true;
+    } else if (strcmp(argv[i], "--wrap-background") == 0) {
+      wrapBackground = true;
+    } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      recordPath = argv[++i];
+    } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      replayPath = argv[++i];
+    } else if (strcmp(argv[i], "--turbo") == 0) {
+      turbo = true;
+    } else if (strcmp(argv[i], "--fast-forward") == 0) {
+      fastForward = FAST_FORWARD_AUTO;
+    } else if (strcmp(argv[i], "--fast-forward-every") == 0 && i + 1 < argc &&
+               atoi(argv[i + 1]) > 0) {
+      fastForward = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--low-res") == 0) {
+      lowRes = true;
+    } else if (strcmp(argv[i], "--ghosts") == 0 && i + 1 < argc &&
+               atoi(argv[i + 1]) >= 0) {
+      ghostCount = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--skin") == 0 && i + 1 < argc &&
+               SkinFind(argv[i + 1]) >= 0) {
+      skin = (Skin)SkinFind(argv[++i]);
+    } else if (strcmp(argv[i], "--particles") == 0 && i + 1 < argc &&
+               atoi(argv[i + 1]) >= 0) {
+      particleCapacity = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+      telemetryPath = argv[++i];
+    } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+      capturePath = argv[++i];
+#ifdef PROFILE
+    } else if (strcmp(argv[i], "--profile-csv") == 0 && i + 1 < argc) {
+      if (!ProfOpenCsv(argv[++i])) {
+        fprintf(stderr, "Cannot write %s\n", argv[i]);
+        return 1;
+      }
+#endif
+    } else {
+      fprintf(stderr, "usage: %s [--pixel-collision] [--wrap-background]"
+                      " [--record <file> | --replay <file> [--turbo]]"
+                      " [--fast-forward | --fast-forward-every <ticks>]"
+                      " [--ghosts <count>] [--low-res]"
+                      " [--skin blue|red|yellow]"
+                      " [--particles <capacity>] [--telemetry <file>]"
+                      " [--capture <file.y4m|file.mp4>]"
+#ifdef PROFILE
+                      " [--profile-csv <file>]"
+#endif
+                      "\n",
+              argv[0]);
+      return 1;
+    }
+  }
 
-  Texture2D bgTexture = LoadTexture("./assets/sprites/background-day.png");
-  if (!IsTextureValid(bgTexture)) {
-    TraceLog(LOG_ERROR, "Failed to load background texture");
-    CloseWindow();
+  if ((recordPath != NULL && replayPath != NULL) ||
+      (turbo && replayPath == NULL)) {
+    fprintf(stderr, "--record and --replay exclude each other, --turbo needs "
+                    "--replay\n");
     return 1;
-  } else {
-    TraceLog(LOG_INFO, "Loaded background texture successfully.");
   }
-  ScrollingBackground background =
-      CreateScrollingBackground(bgTexture, BG_POS_Y, BG_SPEED);
 
-  Texture2D baseTx = LoadTexture("./assets/sprites/base.png");
-  if (!IsTextureValid(baseTx)) {
-    TraceLog(LOG_ERROR, "Failed to load base texture");
-    CloseWindow();
+  // A replay brings its own seed and settings
+  uint64_t seed = (uint64_t)time(NULL);
+  Replay replay = {0};
+  if (replayPath != NULL) {
+    if (!ReplayLoad(&replay, replayPath)) {
+      fprintf(stderr, "Cannot read replay %s\n", replayPath);
+      return 1;
+    }
+    if ((replay.header.flags & REPLAY_FIXED_POINT) != REPLAY_NUMBERS) {
+      fprintf(stderr, "Replay %s needs a %s build\n", replayPath,
+              REPLAY_NUMBERS ? "float" : "FIXED_POINT=1");
+      ReplayFree(&replay);
+      return 1;
+    }
+    seed = replay.header.seed;
+    pixelCollision = replay.header.flags & REPLAY_PIXEL_COLLISION;
+  } else if (recordPath != NULL) {
+    ReplayInit(&replay, seed, pixelCollision ? REPLAY_PIXEL_COLLISION : 0);
+  }
+
+  // Nothing to draw and no masks to build, so no window either
+  if (turbo && !pixelCollision) {
+    return PlayTurbo(&replay, NULL, replayPath);
+  }
+
+  Entities scene;
+  if (!EntitiesInit(&scene, SCENE_COUNT)) {
+    fprintf(stderr, "Cannot allocate the scene\n");
+    ReplayFree(&replay);
     return 1;
-  } else {
-    TraceLog(LOG_INFO, "Loaded background base successfully.");
   }
-  ScrollingBackground base =
-      CreateScrollingBackground(baseTx, BASE_POS_Y, BASE_SPEED);
 
-  Texture2D pipeTexture = LoadTexture("./assets/sprites/pipe-green.png");
-  if (!IsTextureValid(pipeTexture)) {
-    TraceLog(LOG_ERROR, "Failed to pipe texture");
+  InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Flappy birds");
+  SetTargetFPS(60);
+  InitAudioDevice();
+
+  // The baked pack from make assets.pak is used when present, otherwise
+  // every PNG is decoded here
+  Pack pack;
+  bool packed = PackOpen(&pack, ASSET_PACK);
+  TraceLog(LOG_INFO, packed ? "Loading assets from " ASSET_PACK
+                            : "No " ASSET_PACK ", decoding assets/");
+
+  Atlas atlas;
+  BirdSkins skins;
+  Image atlasImage = {0};
+  Image skinImage = {0};
+  Texture2D layers[2] = {0}; // Background and base for --wrap-background
+  Audio audio = {0};
+  bool loaded =
+      packed ? LoadPackedAssets(&pack, &atlas, &skins,
+                                wrapBackground ? layers : NULL,
+                                pixelCollision ? &atlasImage : NULL,
+                                pixelCollision ? &skinImage : NULL, &audio)
+             : LoadAssetsAsync(&atlas, &skins, wrapBackground ? layers : NULL,
+                               pixelCollision ? &atlasImage : NULL,
+                               pixelCollision ? &skinImage : NULL, &audio);
+  if (!loaded) {
+    if (packed) {
+      PackClose(&pack);
+    }
+    EntitiesFree(&scene);
+    CloseAudioDevice();
     CloseWindow();
+    ReplayFree(&replay);
     return 1;
-  } else {
-    TraceLog(LOG_INFO, "Loaded base successfully.");
   }
 
-  Texture2D birdTextures[] = {
-      LoadTexture("./assets/sprites/bluebird-upflap.png"),
-      LoadTexture("./assets/sprites/bluebird-midflap.png"),
-      LoadTexture("./assets/sprites/bluebird-downflap.png"),
-  };
-
-  size_t numTextures = sizeof(birdTextures) / sizeof(birdTextures[0]);
-  for (size_t i = 0; i < numTextures; i++) {
-    if (!IsTextureValid(birdTextures[i])) {
-      TraceLog(LOG_ERROR, "Failed to load bird texture %d!", i);
+  // Tiles from the atlas share the sprite batch, wrapped layers are one quad
+  // each but need their own repeating texture
+  const Sprite pipeSprite = SPRITE_PIPE_GREEN;
+  if (wrapBackground) {
+    EntityAddWrappedLayer(&scene, layers[0], BG_POS_Y, BG_SPEED);
+  } else {
+    EntityAddScrollingLayer(&scene, &atlas, SPRITE_BACKGROUND_DAY, BG_POS_Y,
+                            BG_SPEED);
+  }
+  for (int i = 0; i < PIPE_COUNT; i++) {
+    EntityAddPipe(&scene, &atlas, pipeSprite);
+  }
+  EntityAddBird(&scene, &skins, skin);
+  if (wrapBackground) {
+    EntityAddWrappedLayer(&scene, layers[1], BASE_POS_Y, BASE_SPEED);
+  } else {
+    EntityAddScrollingLayer(&scene, &atlas, SPRITE_BASE, BASE_POS_Y,
+                            BASE_SPEED);
+  }
+  assert(scene.count == SCENE_COUNT);
+
+  static CollisionMasks masks;
+  if (pixelCollision) {
+    bool built = LoadCollisionMasks(&masks, &atlas, atlasImage, &skins,
+                                    skinImage, pipeSprite);
+    UnloadImage(atlasImage);
+    UnloadImage(skinImage);
+    if (!built) {
+      EntitiesFree(&scene);
+      UnloadSkins(&skins);
+      UnloadAtlas(&atlas);
+      if (packed) {
+        PackClose(&pack);
+      }
+      UnloadAudio(&audio);
+      CloseAudioDevice();
       CloseWindow();
+      ReplayFree(&replay);
       return 1;
-    } else {
-      TraceLog(LOG_INFO, "Loaded bird texture %d successfully.", i);
     }
   }
 
-  Bird bird = CreateBird(birdTextures, numTextures);
-
-  // TODO: Tune these
-  Vector2 gravity = {.x = 0, .y = 980.0f};
-  Vector2 jumpForce = {.x = 0, .y = -400.0f};
+  // Everything is on the GPU now
+  if (packed) {
+    PackClose(&pack);
+  }
 
-  float dt; // important
-  while (!WindowShouldClose()) {
-    dt = GetFrameTime();
+  if (turbo) {
+    EntitiesFree(&scene);
+    UnloadSkins(&skins);
+    UnloadAtlas(&atlas);
+    UnloadAudio(&audio);
+    CloseAudioDevice();
+    CloseWindow();
+    return PlayTurbo(&replay, &masks, replayPath);
+  }
 
-    if (IsKeyPressed(KEY_S) && !gameStarted) {
-      gameStarted = true;
+  SimState sim;
+  SimInit(&sim, seed);
+  sim.masks = pixelCollision ? &masks : NULL;
+  SimSnapshot runStart; // Restored by a restart
+  SimSave(&sim, &runStart);
+
+  // Bots on the same level as the player, seeded alike so they see the
+  // same pipes
+  Ghosts ghostStore;
+  Ghosts *ghosts = NULL;
+  if (ghostCount > 0) {
+    if (!CreateGhosts(&ghostStore, ghostCount, seed)) {
+      TraceLog(LOG_ERROR, "Cannot allocate %d ghosts", ghostCount);
+      EntitiesFree(&scene);
+      UnloadSkins(&skins);
+      UnloadAtlas(&atlas);
+      UnloadAudio(&audio);
+      CloseAudioDevice();
+      CloseWindow();
+      ReplayFree(&replay);
+      return 1;
     }
+    ghosts = &ghostStore;
+  }
+  Playback playback = {.replay = &replay,
+                       .recording = recordPath != NULL,
+                       .replaying = replayPath != NULL};
+
+  // Without a render target the world is drawn at window size instead
+  LowResTarget lowResTarget;
+  if (lowRes && !LoadLowResTarget(&lowResTarget)) {
+    TraceLog(LOG_WARNING, "No low resolution target, drawing at full size");
+    lowRes = false;
+  }
 
-    if (IsKeyPressed(KEY_SPACE) && gameStarted) {
-      bird.velocity = jumpForce;
+  // Only for show, so running out of memory only leaves them out
+  Particles particleStore;
+  Particles *particles = NULL;
+  if (particleCapacity > 0) {
+    if (CreateParticles(&particleStore, particleCapacity, &skins, &atlas,
+                        pipeSprite)) {
+      particles = &particleStore;
+    } else {
+      TraceLog(LOG_WARNING, "Cannot allocate %d particles", particleCapacity);
     }
+  }
 
-    if (gameStarted) {
-      bird.velocity = Vector2Add(bird.velocity, Vector2Scale(gravity, dt));
-      bird.velocity.y = Clamp(bird.velocity.y, -1200, 1500);
+  // Both are only redrawn when they change
+  CachedText hint = CreateCachedText(20, DARKGRAY);
+  ScoreDisplay score;
+  bool scoreCached = LoadScoreDisplay(&score, &atlas);
+  if (!scoreCached) {
+    TraceLog(LOG_WARNING, "No score texture, drawing the score as text");
+  }
 
-      bird.position =
-          Vector2Add(bird.position, Vector2Scale(bird.velocity, dt));
+  // The loop paces itself so it can poll while it waits, EndDrawing() must
+  // not sleep for it
+  SetTargetFPS(0);
+
+  InputQueue inputs;
+  InputInit(&inputs);
+#ifdef DEBUG_OVERLAY
+  bool showDebug = false;
+  InputLatch(&inputs, KEY_F1);
+#endif
+#ifdef PROFILE
+  InputLatch(&inputs, KEY_F2);
+#endif
+
+  // Session stats are only for ops, so a file that cannot be opened leaves
+  // them out rather than the game
+  static Telemetry telemetryStore;
+  Telemetry *telemetry = NULL;
+  if (telemetryPath != NULL) {
+    if (TelemetryOpen(&telemetryStore, telemetryPath, seed)) {
+      telemetry = &telemetryStore;
+    } else {
+      TraceLog(LOG_WARNING, "Cannot write telemetry to %s", telemetryPath);
+    }
+  }
 
-      bird.velocity.y *= 0.99f;
+  // A captured replay renders offline: every frame is one video frame of
+  // sim time, as fast as it draws and encodes, silent, and the window
+  // closes when the replay ends
+  static Capture captureStore;
+  Capture *capture = NULL;
+  bool offline = capturePath != NULL && playback.replaying;
+  int status = 0;
+  if (offline) {
+    fastForward = 0; // The video keeps sim time
+  } else if (capturePath != NULL && fastForward != 0) {
+    // Live frames are paced to CAPTURE_FPS, fast forward cannot keep that
+    TraceLog(LOG_ERROR, "--capture of a live game cannot --fast-forward");
+    status = 1; // Straight to the cleanup below
+  }
+  if (status == 0 && capturePath != NULL) {
+    if (CaptureOpen(&captureStore, capturePath, offline)) {
+      capture = &captureStore;
+    } else {
+      status = 1; // Straight to the cleanup below
+    }
+  }
 
-      if (bird.position.y > BASE_POS_Y - bird.radius * SCALE) {
-        bird.position.y = BASE_POS_Y - bird.radius * SCALE;
-        bird.velocity.y = 0;
-      }
+  float dt; // important
+  float accumulator = 0.0f;
+  double frameStart = GetTime();
+  while (status == 0 && !WindowShouldClose()) {
+    double now = GetTime();
+    dt = offline ? 1.0f / CAPTURE_FPS : (float)(now - frameStart);
+    frameStart = now;
+    if (telemetry != NULL) {
+      TelemetryFrame(telemetry, dt);
+    }
 
-      if (bird.position.y < bird.radius * SCALE) {
-        bird.position.y = bird.radius * SCALE;
-        bird.velocity.y = 0;
+    // Sim keys were stamped as they were polled, only toggles are read here
+    PROF_BEGIN(PROF_INPUT);
+#ifdef DEBUG_OVERLAY
+    if (InputLatched(&inputs, KEY_F1)) {
+      showDebug = !showDebug;
+    }
+#endif
+#ifdef PROFILE
+    if (InputLatched(&inputs, KEY_F2)) {
+      PROF_TOGGLE_OVERLAY();
+    }
+#endif
+    PROF_END(PROF_INPUT);
+
+    PROF_BEGIN(PROF_SIM);
+    uint32_t events = 0; // Of every tick this frame, played once per frame
+    float alpha;
+    float scroll = dt; // Seconds of background scroll this frame
+    if (fastForward != 0) {
+      // As many ticks as fit before the next frame is due, or exactly N.
+      // Ticks are not tied to wall time here, so each takes every press
+      // polled so far, and events are polled in between to keep that close.
+      double due = now + 1.0 / FAST_FORWARD_HZ;
+      int ticks = 0;
+      while (fastForward == FAST_FORWARD_AUTO ? GetTime() < due
+                                              : ticks < fastForward) {
+        if (!StepSim(&sim, &runStart, &inputs, GetTime(), &playback,
+                     ghosts)) {
+          // A held replay has nothing left to run, back to normal pacing
+          fastForward = 0;
+          break;
+        }
+        events |= sim.events;
+        if (telemetry != NULL) {
+          TelemetryTick(telemetry, &sim);
+        }
+        if (++ticks % FAST_FORWARD_POLL_TICKS == 0) {
+          PollInputEvents();
+          InputSample(&inputs);
+        }
+      }
+      alpha = 1.0f; // The frame shows the latest tick
+      scroll = ticks * SIM_DT;
+    } else {
+      // A slow frame runs several fixed ticks instead of one big one. The
+      // sim trails now by accumulator, which places each tick's end on the
+      // wall clock.
+      accumulator += dt < MAX_FRAME_TIME ? dt : MAX_FRAME_TIME;
+      double tickEnd = now - accumulator + SIM_DT;
+      while (accumulator >= SIM_DT) {
+        if (!StepSim(&sim, &runStart, &inputs, tickEnd, &playback, ghosts)) {
+          accumulator = 0;
+          break;
+        }
+        events |= sim.events;
+        if (telemetry != NULL) {
+          TelemetryTick(telemetry, &sim);
+        }
+        accumulator -= SIM_DT;
+        tickEnd += SIM_DT;
       }
+      alpha = accumulator / SIM_DT;
+    }
+    PROF_END(PROF_SIM);
+    if (!offline) {
+      PlaySimEvents(&audio, events);
     }
 
+    // Nothing can be seen, so nothing is drawn, the sim still keeps time.
+    // The profiler still gets its frame.
+    if (IsWindowMinimized() && fastForward == 0 && capture == NULL) {
+      PROF_END_FRAME();
+      InputWait(&inputs, frameStart + 1.0 / MINIMIZED_FPS, INPUT_IDLE_SLICE,
+                true);
+      continue;
+    }
+
+    // Sim state in, then the layers scroll on their own
+    // Stopped pipes stay put, like the ghosts
+    EntitiesFollowPipes(&scene, SCENE_PIPES, &sim.pipes,
+                        sim.started && !sim.dead, alpha);
+    EntityFollowBird(&scene, SCENE_BIRD, &sim.bird, alpha);
+    UpdateEntities(&scene, scroll);
+    if (particles != NULL) {
+      SpawnParticles(particles, events, &sim.bird);
+      ParticlesUpdate(&particles->feathers, scroll);
+      ParticlesUpdate(&particles->debris, scroll);
+    }
+
+    PROF_BEGIN(PROF_BACKGROUND);
     BeginDrawing();
     ClearBackground(BLACK);
-    DrawScrollingBackground(&background, dt);
-
-    DrawBird(&bird, dt);
-    DrawScrollingBackground(&base, dt);
+    if (lowRes) {
+      BeginLowRes(&lowResTarget);
+    }
+    DrawEntities(&scene, SCENE_BACKGROUND, SCENE_PIPES);
+    PROF_END(PROF_BACKGROUND);
+
+    PROF_BEGIN(PROF_PIPES);
+    DrawEntities(&scene, SCENE_PIPES, SCENE_BIRD);
+    PROF_END(PROF_PIPES);
+
+    PROF_BEGIN(PROF_BIRD);
+    BeginSkins(&skins);
+    if (ghosts != NULL) {
+      // Ghost pipes are the player's, so they stop at the same tick
+      GhostBatchFromWorld(&ghosts->batch, &ghosts->world,
+                          sim.started && !sim.dead ? alpha : 1.0f,
+                          GHOST_OPACITY);
+      DrawGhostBatch(&ghosts->batch, &skins);
+    }
+    if (particles != NULL) {
+      DrawParticles(&particles->feathers, skins.indices,
+                    particles->featherFrames, 3, SkinTint(skin, 255));
+    }
+    DrawEntities(&scene, SCENE_BIRD, SCENE_BASE);
+    EndSkins();
+    if (particles != NULL) {
+      DrawParticles(&particles->debris, atlas.texture,
+                    particles->debrisFrames, 3, WHITE);
+    }
+    PROF_END(PROF_BIRD);
 
-    if (!gameStarted) {
-      DrawText("Press S to start!", 10, 10, 20, DARKGRAY);
+    PROF_BEGIN(PROF_BASE);
+    DrawEntities(&scene, SCENE_BASE, SCENE_COUNT);
+    if (lowRes) {
+      EndLowRes();
+      DrawLowRes(&lowResTarget);
+    }
+    PROF_END(PROF_BASE);
+
+    PROF_BEGIN(PROF_UI);
+    const char *hintText = !sim.started ? "Press S to start!"
+                           : !sim.dead  ? "Press SPACE to jump!"
+                           : playback.replaying
+                               ? "Game over!"
+                               : "Game over! Press S to retry";
+    DrawCachedText(&hint, hintText, 10, 10);
+    if (scoreCached) {
+      DrawScoreDisplay(&score, sim.score, SCREEN_WIDTH / 2.0f, 40);
     } else {
-      DrawText("Press SPACE to jump!", 10, 10, 20, DARKGRAY);
+      DrawText(TextFormat("Score: %u", sim.score), 10, 40, 20, DARKGRAY);
+    }
+
+#ifdef DEBUG_OVERLAY
+    if (showDebug) {
+      DrawDebugOverlay(&scene, &sim.bird, alpha);
     }
+#endif
+    PROF_DRAW_OVERLAY();
+    PROF_END(PROF_UI);
 
+    PROF_BEGIN(PROF_PRESENT);
+    if (capture != NULL) {
+      CaptureFrame(capture);
+    }
     EndDrawing();
+    InputSample(&inputs);
+    if (inputs.applied != 0) {
+      PROF_INPUT_LATENCY((float)(GetTime() - inputs.applied) * 1000.0f);
+      inputs.applied = 0;
+    }
+    PROF_END(PROF_PRESENT);
+    PROF_END_FRAME();
+
+    if (offline && playback.checked) {
+      break; // The last frame of the replay is in
+    }
+
+    // Fast forward and offline capture are already due, everything else
+    // waits out the frame polling, so presses are stamped close to when
+    // they happened. Only a throttled frame ends early on a press, a full
+    // rate one is short anyway and keeps its pacing. Captured frames keep
+    // one rate, the video has one.
+    if (fastForward == 0 && !offline) {
+      int rate = capture != NULL ? CAPTURE_FPS : FrameRate(&sim);
+      InputWait(&inputs, frameStart + 1.0 / rate,
+                rate == TARGET_FPS ? INPUT_POLL_SLICE : INPUT_IDLE_SLICE,
+                capture == NULL && rate != TARGET_FPS);
+    }
   }
 
-  DestroyBird(&bird);
-  DestroyAnimation(&background);
-  DestroyAnimation(&base);
+  if (capture != NULL) {
+    CaptureClose(capture);
+  }
+  if (playback.recording) {
+    ReplayEnd(&replay, &sim);
+    if (ReplaySave(&replay, recordPath)) {
+      TraceLog(LOG_INFO, "Recorded %llu ticks to %s",
+               (unsigned long long)sim.tick, recordPath);
+    } else {
+      TraceLog(LOG_ERROR, "Cannot write replay %s", recordPath);
+    }
+  }
+  ReplayFree(&replay);
+  if (telemetry != NULL) {
+    TelemetryClose(telemetry, inputs.dropped);
+  }
+  if (ghosts != NULL) {
+    DestroyGhosts(ghosts);
+  }
+  if (particles != NULL) {
+    DestroyParticles(particles);
+  }
+  if (lowRes) {
+    UnloadLowResTarget(&lowResTarget);
+  }
+  if (scoreCached) {
+    UnloadScoreDisplay(&score);
+  }
+  UnloadCachedText(&hint);
+
+#ifdef PROFILE
+  ProfClose();
+#endif
+  EntitiesFree(&scene);
+  UnloadSkins(&skins);
+  UnloadAtlas(&atlas);
+  UnloadAudio(&audio);
+  CloseAudioDevice();
   CloseWindow();
-  return 0;
+  return status;
 }
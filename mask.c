@@ -0,0 +1,135 @@
+#include "mask.h"
+#include "collision.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#define MASK_PI 3.14159265358979f
+
+static bool IsSolid(const uint8_t *pixels, int stride, int x, int y) {
+  return pixels[((size_t)y * stride + x) * 4 + 3] >= MASK_ALPHA_THRESHOLD;
+}
+
+bool MaskBuildBird(CollisionMasks *masks, int frame, const uint8_t *pixels,
+                   int width, int height, int stride) {
+  assert(masks != NULL);
+  assert(pixels != NULL);
+
+  if (frame < 0 || frame >= BIRD_FRAMES ||
+      width * width + height * height > MASK_BIRD_SIZE * MASK_BIRD_SIZE) {
+    return false;
+  }
+
+  float centerX = width / 2.0f;
+  float centerY = height / 2.0f;
+
+  for (int a = 0; a < MASK_ANGLES; a++) {
+    // raylib rotates clockwise on screen, walk back from each mask pixel to
+    // the sprite pixel it shows
+    float radians = a * (2.0f * MASK_PI / MASK_ANGLES);
+    float c = cosf(radians);
+    float s = sinf(radians);
+
+    uint64_t *rows = masks->bird[frame][a];
+    memset(rows, 0, sizeof(masks->bird[frame][a]));
+
+    for (int y = 0; y < MASK_BIRD_SIZE; y++) {
+      for (int x = 0; x < MASK_BIRD_SIZE; x++) {
+        float dx = x + 0.5f - MASK_BIRD_SIZE / 2.0f;
+        float dy = y + 0.5f - MASK_BIRD_SIZE / 2.0f;
+        int sx = (int)floorf(c * dx + s * dy + centerX);
+        int sy = (int)floorf(-s * dx + c * dy + centerY);
+
+        if (sx >= 0 && sx < width && sy >= 0 && sy < height &&
+            IsSolid(pixels, stride, sx, sy)) {
+          rows[y] |= 1ULL << x;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool MaskBuildPipe(CollisionMasks *masks, const uint8_t *pixels, int width,
+                   int height, int stride) {
+  assert(masks != NULL);
+  assert(pixels != NULL);
+
+  if (width != MASK_PIPE_WIDTH || height != MASK_PIPE_HEIGHT) {
+    return false;
+  }
+
+  for (int y = 0; y < height; y++) {
+    masks->pipe[y] = 0;
+    for (int x = 0; x < width; x++) {
+      if (IsSolid(pixels, stride, x, y)) {
+        masks->pipe[y] |= 1ULL << x;
+      }
+    }
+  }
+  return true;
+}
+
+// Bird row moved offset columns right, into the pipe's columns
+static uint64_t ShiftRow(uint64_t row, int offset) {
+  if (offset >= 64 || offset <= -64) {
+    return 0;
+  }
+  return offset >= 0 ? row << offset : row >> -offset;
+}
+
+// offsetX/offsetY place the bird mask's top-left corner relative to the
+// pipe's, flipped reads the pipe rows bottom up for the top pipe
+static bool Overlaps(const CollisionMasks *masks, const uint64_t *bird,
+                     int offsetX, int offsetY, bool flipped) {
+  int first = offsetY < 0 ? -offsetY : 0;
+  int last = MASK_PIPE_HEIGHT - offsetY;
+  last = last > MASK_BIRD_SIZE ? MASK_BIRD_SIZE : last;
+
+  for (int row = first; row < last; row++) {
+    int pipeRow = row + offsetY;
+    if (flipped) {
+      pipeRow = MASK_PIPE_HEIGHT - 1 - pipeRow;
+    }
+    if (masks->pipe[pipeRow] & ShiftRow(bird[row], offsetX)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool MaskBirdHitsPipe(const CollisionMasks *masks, int frame, float angle,
+                      float x, float y, const Pipe *pipe) {
+  assert(masks != NULL);
+  assert(pipe != NULL);
+  assert(frame >= 0 && frame < BIRD_FRAMES);
+
+  int index = (int)floorf(angle / (360.0f / MASK_ANGLES) + 0.5f);
+  index = ((index % MASK_ANGLES) + MASK_ANGLES) % MASK_ANGLES;
+  const uint64_t *bird = masks->bird[frame][index];
+
+  // Both sprites are drawn at SCALE, so compare them unscaled
+  float left = x - MASK_BIRD_EXTENT;
+  float top = y - MASK_BIRD_EXTENT;
+  int offsetX = (int)floorf((left - pipe->x) / SCALE + 0.5f);
+
+  float gapTop = PipeGapTop(pipe);
+  float gapBottom = PipeGapBottom(pipe);
+
+  if (top < gapTop) {
+    int offsetY =
+        (int)floorf((top - (gapTop - PIPE_HEIGHT)) / SCALE + 0.5f);
+    if (Overlaps(masks, bird, offsetX, offsetY, true)) {
+      return true;
+    }
+  }
+  if (y + MASK_BIRD_EXTENT > gapBottom) {
+    int offsetY = (int)floorf((top - gapBottom) / SCALE + 0.5f);
+    if (Overlaps(masks, bird, offsetX, offsetY, false)) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,47 @@
+#ifndef MASK_H
+#define MASK_H
+
+// 1-bit alpha masks for pixel-accurate collision. Each mask row is packed
+// into one 64-bit word in unscaled sprite pixels, so testing two sprites is
+// one shift and AND per overlapping row. Bird masks are rotated ahead of
+// time, the pipe mask is shared by the top and the bottom pipe.
+
+#include "config.h"
+#include "pipes.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Square that holds the 34x24 bird sprite at any angle
+#define MASK_BIRD_SIZE 48
+#define MASK_ANGLES 32
+
+// Size of pipe-*.png
+#define MASK_PIPE_WIDTH 52
+#define MASK_PIPE_HEIGHT 320
+
+// Pixels with at least this alpha are solid
+#define MASK_ALPHA_THRESHOLD 128
+
+typedef struct {
+  // Bit x of a row is column x, bird masks are centered on the sprite center
+  uint64_t bird[BIRD_FRAMES][MASK_ANGLES][MASK_BIRD_SIZE];
+  uint64_t pipe[MASK_PIPE_HEIGHT]; // Bottom pipe, opening at row 0
+} CollisionMasks;
+
+// pixels are 8-bit RGBA, as raylib's PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, with
+// stride pixels per row so a sprite can be read straight out of an atlas.
+// Both return false if the image does not fit the mask.
+bool MaskBuildBird(CollisionMasks *masks, int frame, const uint8_t *pixels,
+                   int width, int height, int stride);
+bool MaskBuildPipe(CollisionMasks *masks, const uint8_t *pixels, int width,
+                   int height, int stride);
+
+// Half the bird mask in screen pixels, for the bounding box broadphase
+#define MASK_BIRD_EXTENT (MASK_BIRD_SIZE / 2 * SCALE)
+
+// x, y is the bird center in screen pixels, angle in degrees as drawn
+bool MaskBirdHitsPipe(const CollisionMasks *masks, int frame, float angle,
+                      float x, float y, const Pipe *pipe);
+
+#endif
@@ -0,0 +1,142 @@
+#include "pack.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define PACK_NO_MMAP
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef PACK_NO_MMAP
+static bool ReadWhole(Pack *pack, const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  unsigned char *data = size > 0 ? malloc((size_t)size) : NULL;
+  bool read = data != NULL && fread(data, 1, (size_t)size, file) == (size_t)size;
+  fclose(file);
+  if (!read) {
+    free(data);
+    return false;
+  }
+
+  pack->base = data;
+  pack->size = (size_t)size;
+  pack->mapped = false;
+  return true;
+}
+#else
+static bool Map(Pack *pack, const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+
+  void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps the file alive
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  pack->base = data;
+  pack->size = (size_t)info.st_size;
+  pack->mapped = true;
+  return true;
+}
+#endif
+
+static bool Validate(const Pack *pack) {
+  if (pack->size < sizeof(PackHeader)) {
+    return false;
+  }
+
+  const PackHeader *header = pack->header;
+  if (header->magic != PACK_MAGIC || header->version != PACK_VERSION) {
+    return false;
+  }
+
+  size_t indexEnd =
+      sizeof(PackHeader) + (size_t)header->entryCount * sizeof(PackEntry);
+  if (indexEnd > pack->size) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < header->entryCount; i++) {
+    const PackEntry *entry = &pack->entries[i];
+    if (entry->name[PACK_NAME_LENGTH - 1] != '\0' ||
+        entry->offset % PACK_ALIGN != 0 || entry->offset > pack->size ||
+        entry->size > pack->size - entry->offset) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PackOpen(Pack *pack, const char *path) {
+  assert(pack != NULL);
+  assert(path != NULL);
+
+  *pack = (Pack){0};
+#ifdef PACK_NO_MMAP
+  if (!ReadWhole(pack, path)) {
+    return false;
+  }
+#else
+  if (!Map(pack, path)) {
+    return false;
+  }
+#endif
+
+  pack->header = (const PackHeader *)pack->base;
+  pack->entries = (const PackEntry *)(pack->base + sizeof(PackHeader));
+  if (!Validate(pack)) {
+    PackClose(pack);
+    return false;
+  }
+  return true;
+}
+
+void PackClose(Pack *pack) {
+  assert(pack != NULL);
+
+  if (pack->base != NULL) {
+#ifdef PACK_NO_MMAP
+    free((void *)pack->base);
+#else
+    munmap((void *)pack->base, pack->size);
+#endif
+  }
+  *pack = (Pack){0};
+}
+
+const PackEntry *PackFind(const Pack *pack, const char *name, PackType type) {
+  assert(pack != NULL);
+  assert(name != NULL);
+
+  for (uint32_t i = 0; i < pack->header->entryCount; i++) {
+    const PackEntry *entry = &pack->entries[i];
+    if (entry->type == (uint32_t)type && strcmp(entry->name, name) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
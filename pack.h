@@ -0,0 +1,69 @@
+#ifndef PACK_H
+#define PACK_H
+
+// Baked asset pack. The packer tool decodes assets/ once at build time into
+// GPU-ready pixels (DXT1 blocks, palette indices, RGBA8) and PCM samples.
+// The game maps the file and hands the mapped pages straight to the GPU and
+// the mixer, nothing is decoded or copied at startup unless the GPU cannot
+// take DXT1. Does not depend on raylib.
+//
+// Layout, all integers in the byte order of the host that baked it. The
+// index is read in place and the samples go to the mixer as they are, so a
+// pack is a build product for one byte order like the binary, and one from
+// the other order fails the PACK_MAGIC check.
+//   PackHeader
+//   PackEntry[entryCount]
+//   entry data, each entry starting on a PACK_ALIGN boundary
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PACK_MAGIC 0x4B504C46u // "FLPK"
+#define PACK_VERSION 2u // 2: DXT1 textures and bird skins
+#define PACK_ALIGN 4096u
+#define PACK_NAME_LENGTH 32
+
+typedef enum {
+  PACK_IMAGE = 1, // params: width, height, raylib pixel format, mipmaps
+  PACK_WAVE = 2,  // params: frame count, sample rate, sample size, channels
+  PACK_DATA = 3,  // Opaque bytes
+} PackType;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t reserved;
+} PackHeader;
+
+typedef struct {
+  char name[PACK_NAME_LENGTH]; // NUL terminated
+  uint32_t type;
+  uint32_t params[4];
+  uint32_t reserved;
+  uint64_t offset; // From the start of the file
+  uint64_t size;
+} PackEntry;
+
+typedef struct {
+  const unsigned char *base;
+  size_t size;
+  bool mapped; // false when the file was read into memory instead
+  const PackHeader *header;
+  const PackEntry *entries;
+} Pack;
+
+// Maps the file and checks the index. Returns false if it is missing or
+// malformed.
+bool PackOpen(Pack *pack, const char *path);
+void PackClose(Pack *pack);
+
+// Entry with that name and type, or NULL
+const PackEntry *PackFind(const Pack *pack, const char *name, PackType type);
+
+static inline const void *PackData(const Pack *pack, const PackEntry *entry) {
+  return pack->base + entry->offset;
+}
+
+#endif
@@ -0,0 +1,174 @@
+// Bakes assets/ into one pack file, see pack.h for the format.
+//
+//   ./packer assets assets.pak
+
+#include "assets.h"
+#include "atlas.h"
+#include "dxt.h"
+#include "pack.h"
+#include "raylib.h"
+#include "skins.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ENTRIES 32
+
+// Standalone copies of the scrolling layers, they need their own repeating
+// texture in --wrap-background mode
+static const char *layerNames[] = {"background-day", "background-night",
+                                   "base"};
+static const char *soundNames[] = {"die", "hit", "point", "swoosh", "wing"};
+
+typedef struct {
+  PackEntry entries[MAX_ENTRIES];
+  const void *data[MAX_ENTRIES];
+  int count;
+} PackBuilder;
+
+static void Add(PackBuilder *builder, const char *name, PackType type,
+                const uint32_t params[4], const void *data, uint64_t size) {
+  if (builder->count == MAX_ENTRIES) {
+    fprintf(stderr, "packer: too many entries\n");
+    exit(1);
+  }
+
+  PackEntry *entry = &builder->entries[builder->count];
+  *entry = (PackEntry){.type = type, .size = size};
+  snprintf(entry->name, sizeof(entry->name), "%s", name);
+  if (params != NULL) {
+    memcpy(entry->params, params, sizeof(entry->params));
+  }
+  builder->data[builder->count++] = data;
+}
+
+static void AddImage(PackBuilder *builder, const char *name, Image image) {
+  uint32_t params[4] = {image.width, image.height, image.format,
+                        image.mipmaps};
+  Add(builder, name, PACK_IMAGE, params, image.data,
+      PackImageSize(image.width, image.height, image.format, image.mipmaps));
+}
+
+// DXT1 copy of an RGBA8 image, 8 times smaller on disk and on the GPU. Left
+// as it is when the size is not a multiple of the block size. The packer
+// exits right after writing, so nothing here is freed.
+static Image Compress(Image image) {
+  if (image.width % 4 != 0 || image.height % 4 != 0) {
+    fprintf(stderr, "packer: %dx%d is not a multiple of 4, left as RGBA8\n",
+            image.width, image.height);
+    return image;
+  }
+
+  uint8_t *blocks = malloc(DxtSize(image.width, image.height));
+  if (blocks == NULL) {
+    fprintf(stderr, "packer: out of memory\n");
+    exit(1);
+  }
+  DxtCompress(image.data, image.width, image.height, blocks);
+  return (Image){.data = blocks,
+                 .width = image.width,
+                 .height = image.height,
+                 .mipmaps = 1,
+                 .format = PIXELFORMAT_COMPRESSED_DXT1_RGBA};
+}
+
+static bool Write(PackBuilder *builder, const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return false;
+  }
+
+  uint64_t offset =
+      sizeof(PackHeader) + (uint64_t)builder->count * sizeof(PackEntry);
+  for (int i = 0; i < builder->count; i++) {
+    offset = (offset + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+    builder->entries[i].offset = offset;
+    offset += builder->entries[i].size;
+  }
+
+  PackHeader header = {.magic = PACK_MAGIC,
+                       .version = PACK_VERSION,
+                       .entryCount = (uint32_t)builder->count};
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            fwrite(builder->entries, sizeof(PackEntry), builder->count,
+                   file) == (size_t)builder->count;
+
+  static const unsigned char zeros[PACK_ALIGN];
+  for (int i = 0; ok && i < builder->count; i++) {
+    long padding = (long)builder->entries[i].offset - ftell(file);
+    ok = fwrite(zeros, 1, (size_t)padding, file) == (size_t)padding &&
+         fwrite(builder->data[i], 1, builder->entries[i].size, file) ==
+             builder->entries[i].size;
+  }
+
+  return fclose(file) == 0 && ok;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <assets dir> <output pack>\n", argv[0]);
+    return 1;
+  }
+  const char *assets = argv[1];
+
+  PackBuilder builder = {0};
+
+  static Image sprites[SPRITE_COUNT];
+  if (!LoadSpriteImages(TextFormat("%s/sprites", assets), sprites)) {
+    return 1;
+  }
+
+  // The birds first, packing the atlas unloads every sprite
+  static Rectangle skinRects[BIRD_FRAMES];
+  Image indices;
+  Image palettes;
+  if (!BuildSkinImages(sprites, skinRects, &indices, &palettes)) {
+    return 1;
+  }
+  AddImage(&builder, SKIN_INDICES_ENTRY, indices);
+  AddImage(&builder, SKIN_PALETTES_ENTRY, palettes);
+  Add(&builder, SKIN_RECTS_ENTRY, PACK_DATA, NULL, skinRects,
+      sizeof(skinRects));
+
+  static Rectangle rects[SPRITE_COUNT];
+  Image atlas;
+  if (!PackAtlasImages(sprites, rects, &atlas)) {
+    return 1;
+  }
+  AddImage(&builder, ATLAS_IMAGE_ENTRY, Compress(atlas));
+  Add(&builder, ATLAS_RECTS_ENTRY, PACK_DATA, NULL, rects, sizeof(rects));
+
+  Image layers[sizeof(layerNames) / sizeof(layerNames[0])];
+  for (size_t i = 0; i < sizeof(layerNames) / sizeof(layerNames[0]); i++) {
+    layers[i] = LoadImage(TextFormat("%s/sprites/%s.png", assets, layerNames[i]));
+    if (!IsImageValid(layers[i])) {
+      fprintf(stderr, "packer: failed to load %s\n", layerNames[i]);
+      return 1;
+    }
+    ImageFormat(&layers[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    AddImage(&builder, layerNames[i], Compress(layers[i]));
+  }
+
+  // WAV rather than OGG, so the game gets PCM without decoding anything
+  Wave sounds[sizeof(soundNames) / sizeof(soundNames[0])];
+  for (size_t i = 0; i < sizeof(soundNames) / sizeof(soundNames[0]); i++) {
+    sounds[i] = LoadWave(TextFormat("%s/audio/%s.wav", assets, soundNames[i]));
+    if (!IsWaveValid(sounds[i])) {
+      fprintf(stderr, "packer: failed to load %s\n", soundNames[i]);
+      return 1;
+    }
+    uint32_t params[4] = {sounds[i].frameCount, sounds[i].sampleRate,
+                          sounds[i].sampleSize, sounds[i].channels};
+    Add(&builder, soundNames[i], PACK_WAVE, params, sounds[i].data,
+        (uint64_t)sounds[i].frameCount * sounds[i].channels *
+            sounds[i].sampleSize / 8);
+  }
+
+  if (!Write(&builder, argv[2])) {
+    fprintf(stderr, "packer: failed to write %s\n", argv[2]);
+    return 1;
+  }
+  printf("packer: wrote %d entries to %s\n", builder.count, argv[2]);
+  return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef PARTICLE_H
+#define PARTICLE_H
+
+// Short lived cosmetic particles, feathers on a flap and debris on a crash.
+// A pool has a fixed capacity and keeps every field in its own array, live
+// particles packed at the front: dead ones are swap removed, so spawning and
+// freeing never allocate and the update is one pass over count entries.
+// Nothing here needs raylib, DrawParticles() in render.h draws a pool.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Seconds before the end of its life a particle starts fading out
+#define PARTICLE_FADE 0.25f
+
+typedef struct {
+  int capacity;
+  int count;
+  float gravity; // Pixels per second squared, down is positive
+  float *x;
+  float *y;
+  float *vx;
+  float *vy;
+  float *life; // Seconds left
+  uint8_t *frame;
+  uint64_t rng;
+  uint64_t dropped; // Spawns that found the pool full
+} ParticlePool;
+
+typedef struct {
+  int count;   // Particles per burst
+  float speed; // Up to this many pixels per second along either axis
+  float lift;  // Upward speed added to every particle
+  float life;  // Seconds, each particle gets between half and all of it
+  int frames;  // Frames to pick from, 0 to frames - 1
+} ParticleBurst;
+
+bool ParticlesInit(ParticlePool *pool, int capacity, float gravity);
+void ParticlesFree(ParticlePool *pool);
+
+// Spawns burst->count particles at x, y. Returns how many fit, the rest are
+// counted in dropped.
+int ParticlesBurst(ParticlePool *pool, const ParticleBurst *burst, float x,
+                   float y);
+
+// Moves every particle by dt seconds, then frees the ones that ran out
+void ParticlesUpdate(ParticlePool *pool, float dt);
+
+#endif
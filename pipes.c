@@ -0,0 +1,91 @@
+#include "pipes.h"
+#include "fixed.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+float PipeGapY(uint64_t seed, uint64_t index) {
+  // splitmix64 of the counter, every index gets an independent draw
+  uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+
+#ifdef SIM_FIXED_POINT
+  // The same 24 bits of t scaled in integers
+  int64_t range = SIM_VALUE(PIPE_GAP_MAX_Y - PIPE_GAP_MIN_Y);
+  return SimFloat(SIM_VALUE(PIPE_GAP_MIN_Y) +
+                  (SimValue)((int64_t)(z >> 40) * range >> 24));
+#else
+  float t = (float)(z >> 40) / (float)(1u << 24);
+  return PIPE_GAP_MIN_Y + t * (PIPE_GAP_MAX_Y - PIPE_GAP_MIN_Y);
+#endif
+}
+
+float PipeX(uint64_t index, uint64_t ticks) {
+#ifdef SIM_FIXED_POINT
+  // Only pipes near the screen are placed, so the difference fits
+  int64_t scrolled = (int64_t)ticks * SIM_VALUE(BASE_SPEED / SIM_HZ);
+  return SimFloat((SimValue)(SIM_VALUE(SCREEN_WIDTH) +
+                             (int64_t)index * SIM_VALUE(PIPE_SPACING) -
+                             scrolled));
+#else
+  // In double so long runs keep sub-pixel precision before the cast
+  return (float)(SCREEN_WIDTH + (double)index * PIPE_SPACING -
+                 (double)ticks * (BASE_SPEED * SIM_DT));
+#endif
+}
+
+static void PlacePipe(PipeRing *ring, uint64_t index) {
+  Pipe *pipe = &ring->pipes[index % PIPE_COUNT];
+  pipe->x = PipeX(index, ring->ticks);
+  pipe->gapY = PipeGapY(ring->seed, index);
+}
+
+void PipeRingInit(PipeRing *ring, uint64_t seed) {
+  assert(ring != NULL);
+
+  ring->seed = seed;
+  PipeRingSeek(ring, 0);
+}
+
+void PipeRingSeek(PipeRing *ring, uint64_t ticks) {
+  assert(ring != NULL);
+
+  // Leftmost pipe still on screen, found from the same float x that
+  // PipeRingStep() tests so both agree at the boundary
+  double scrolled = (double)ticks * (BASE_SPEED * SIM_DT);
+  double estimate = (scrolled - SCREEN_WIDTH - PIPE_WIDTH) / PIPE_SPACING;
+  uint64_t first = estimate > 0 ? (uint64_t)estimate : 0;
+  while (first > 0 && PipeX(first - 1, ticks) + PIPE_WIDTH >= 0) {
+    first--;
+  }
+  while (PipeX(first, ticks) + PIPE_WIDTH < 0) {
+    first++;
+  }
+
+  ring->ticks = ticks;
+  ring->first = first;
+  ring->head = (int)(first % PIPE_COUNT);
+  for (int i = 0; i < PIPE_COUNT; i++) {
+    PlacePipe(ring, first + i);
+  }
+}
+
+void PipeRingStep(PipeRing *ring) {
+  assert(ring != NULL);
+
+  ring->ticks++;
+  for (int i = 0; i < PIPE_COUNT; i++) {
+    int slot = ring->head + i;
+    slot -= slot >= PIPE_COUNT ? PIPE_COUNT : 0;
+    ring->pipes[slot].x = PipeX(ring->first + i, ring->ticks);
+  }
+
+  // Pipes are sorted by x, so only the head can have left the screen
+  if (ring->pipes[ring->head].x + PIPE_WIDTH < 0) {
+    PlacePipe(ring, ring->first + PIPE_COUNT);
+    ring->first++;
+    ring->head = (ring->head + 1) % PIPE_COUNT;
+  }
+}
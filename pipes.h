@@ -0,0 +1,61 @@
+#ifndef PIPES_H
+#define PIPES_H
+
+// Pipes live in a fixed ring buffer. Every slot is in use all the time, a
+// pipe that scrolls off the left edge is moved behind the rightmost one, so
+// nothing is allocated while the game runs.
+//
+// Pipe k of a level is a pure function of the seed, k and how far the level
+// has scrolled: its gap comes from a counter-based hash of (seed, k) and its
+// x from the scroll distance. Recycling a slot computes pipe k + PIPE_COUNT,
+// and any point of the level can be reached without stepping to it.
+
+#include "config.h"
+
+#include <stdint.h>
+
+// Size of pipe-green.png, scaled to screen pixels
+#define PIPE_WIDTH (52 * SCALE)
+#define PIPE_HEIGHT (320 * SCALE)
+
+// Enough pipes to cover the screen plus one entering and one leaving
+#define PIPE_COUNT (SCREEN_WIDTH / PIPE_SPACING + 2)
+
+// Range for the center of the gap, keeps both pipes visible
+#define PIPE_GAP_MARGIN 50
+#define PIPE_GAP_MIN_Y (PIPE_GAP / 2 + PIPE_GAP_MARGIN)
+#define PIPE_GAP_MAX_Y (BASE_POS_Y - PIPE_GAP / 2 - PIPE_GAP_MARGIN)
+
+typedef struct {
+  float x;    // Left edge, in screen pixels
+  float gapY; // Center of the gap
+} Pipe;
+
+typedef struct {
+  Pipe pipes[PIPE_COUNT]; // Pipe k lives in slot k % PIPE_COUNT
+  int head;               // Slot of the leftmost pipe
+  uint64_t seed;
+  uint64_t first; // Index of the leftmost pipe
+  uint64_t ticks; // Ticks scrolled since PipeRingInit()
+} PipeRing;
+
+// Gap center of pipe index for a level seed
+float PipeGapY(uint64_t seed, uint64_t index);
+// Left edge of pipe index after scrolling for ticks
+float PipeX(uint64_t index, uint64_t ticks);
+
+void PipeRingInit(PipeRing *ring, uint64_t seed);
+
+// Puts the ring where ticks calls to PipeRingStep() would, in O(PIPE_COUNT)
+void PipeRingSeek(PipeRing *ring, uint64_t ticks);
+
+// Scrolls every pipe left by one sim tick at BASE_SPEED, recycling the ones
+// that left the screen
+void PipeRingStep(PipeRing *ring);
+
+// index counts from the leftmost pipe, so pipes come out sorted by x
+static inline const Pipe *PipeRingGet(const PipeRing *ring, int index) {
+  return &ring->pipes[(ring->head + index) % PIPE_COUNT];
+}
+
+#endif
@@ -0,0 +1,154 @@
+// Only built with make PROFILE=1
+
+#include "prof.h"
+#include "raylib.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+Profiler profiler = {.currentLatency = -1};
+
+static const char *phaseNames[PROF_PHASES + 1] = {
+    "input", "sim", "background", "pipes", "bird",
+    "base",  "ui",  "present",    "frame",
+};
+
+uint64_t ProfNow(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+bool ProfOpenCsv(const char *path) {
+  profiler.csv = fopen(path, "w");
+  if (profiler.csv == NULL) {
+    return false;
+  }
+
+  // Large buffer so rows hit the disk in big chunks, not every frame
+  setvbuf(profiler.csv, NULL, _IOFBF, 1 << 20);
+  fprintf(profiler.csv, "frame");
+  for (int i = 0; i <= PROF_PHASES; i++) {
+    fprintf(profiler.csv, ",%s_ms", phaseNames[i]);
+  }
+  fprintf(profiler.csv, ",input_latency_ms\n");
+  return true;
+}
+
+void ProfClose(void) {
+  if (profiler.csv != NULL) {
+    fclose(profiler.csv);
+    profiler.csv = NULL;
+  }
+}
+
+void ProfInputLatency(float ms) {
+  // Several presses in one frame keep the oldest, which waited longest
+  if (ms > profiler.currentLatency) {
+    profiler.currentLatency = ms;
+  }
+}
+
+void ProfEndFrame(void) {
+  uint64_t now = ProfNow();
+  float total =
+      profiler.frameStart != 0 ? (now - profiler.frameStart) / 1e6f : 0;
+  profiler.frameStart = now;
+
+  int slot = profiler.frame % PROF_WINDOW;
+  for (int i = 0; i < PROF_PHASES; i++) {
+    profiler.samples[i][slot] = profiler.current[i];
+  }
+  profiler.samples[PROF_PHASES][slot] = total;
+
+  int bin = (int)total;
+  bin = bin >= PROF_HISTOGRAM_BINS ? PROF_HISTOGRAM_BINS - 1 : bin;
+  profiler.histogram[bin]++;
+
+  if (profiler.currentLatency >= 0) {
+    profiler.latency[profiler.latencyCount % PROF_WINDOW] =
+        profiler.currentLatency;
+    profiler.latencyCount++;
+  }
+
+  if (profiler.csv != NULL) {
+    fprintf(profiler.csv, "%llu", (unsigned long long)profiler.frame);
+    for (int i = 0; i < PROF_PHASES; i++) {
+      fprintf(profiler.csv, ",%.4f", profiler.current[i]);
+    }
+    fprintf(profiler.csv, ",%.4f,", total);
+    if (profiler.currentLatency >= 0) {
+      fprintf(profiler.csv, "%.4f", profiler.currentLatency);
+    }
+    fprintf(profiler.csv, "\n");
+  }
+  profiler.currentLatency = -1;
+
+  memset(profiler.current, 0, sizeof(profiler.current));
+  profiler.frame++;
+}
+
+static int CompareFloat(const void *a, const void *b) {
+  float fa = *(const float *)a;
+  float fb = *(const float *)b;
+  return (fa > fb) - (fa < fb);
+}
+
+void ProfDrawOverlay(void) {
+  if (!profiler.overlay) {
+    return;
+  }
+
+  int count = profiler.frame < PROF_WINDOW ? (int)profiler.frame : PROF_WINDOW;
+  if (count == 0) {
+    return;
+  }
+
+  const int x = 10;
+  int y = 80;
+  DrawRectangle(x - 5, y - 5, 330, 20 * (PROF_PHASES + 3) + 110,
+                Fade(BLACK, 0.7f));
+  DrawText("phase        p50     p99     max (ms)", x, y, 10, RAYWHITE);
+  y += 20;
+
+  float sorted[PROF_WINDOW];
+  for (int i = 0; i <= PROF_PHASES; i++) {
+    memcpy(sorted, profiler.samples[i], count * sizeof(float));
+    qsort(sorted, count, sizeof(float), CompareFloat);
+    DrawText(TextFormat("%-10s %7.3f %7.3f %7.3f", phaseNames[i],
+                        sorted[count / 2], sorted[(count * 99) / 100],
+                        sorted[count - 1]),
+             x, y, 10, RAYWHITE);
+    y += 20;
+  }
+
+  int presses = profiler.latencyCount < PROF_WINDOW
+                    ? (int)profiler.latencyCount
+                    : PROF_WINDOW;
+  if (presses > 0) {
+    memcpy(sorted, profiler.latency, presses * sizeof(float));
+    qsort(sorted, presses, sizeof(float), CompareFloat);
+    DrawText(TextFormat("%-10s %7.3f %7.3f %7.3f", "input lat",
+                        sorted[presses / 2], sorted[(presses * 99) / 100],
+                        sorted[presses - 1]),
+             x, y, 10, RAYWHITE);
+  } else {
+    DrawText("input lat  no presses yet", x, y, 10, RAYWHITE);
+  }
+  y += 20;
+
+  // Frame time histogram since startup, 1 ms per bar
+  uint32_t peak = 1;
+  for (int i = 0; i < PROF_HISTOGRAM_BINS; i++) {
+    peak = profiler.histogram[i] > peak ? profiler.histogram[i] : peak;
+  }
+  const int height = 80;
+  for (int i = 0; i < PROF_HISTOGRAM_BINS; i++) {
+    int bar = (int)(profiler.histogram[i] * (uint64_t)height / peak);
+    DrawRectangle(x + i * 9, y + height - bar, 8, bar,
+                  i < 17 ? GREEN : (i < 33 ? YELLOW : RED));
+  }
+  DrawText("0", x, y + height + 2, 10, RAYWHITE);
+  DrawText(">33 ms", x + 33 * 9 - 20, y + height + 2, 10, RAYWHITE);
+}
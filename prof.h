@@ -0,0 +1,76 @@
+#ifndef PROF_H
+#define PROF_H
+
+// Per-phase frame profiler. Built only with make PROFILE=1, otherwise every
+// PROF_* macro expands to nothing and none of this is compiled in.
+
+#ifdef PROFILE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+  PROF_INPUT,
+  PROF_SIM,
+  PROF_BACKGROUND,
+  PROF_PIPES,
+  PROF_BIRD,
+  PROF_BASE,
+  PROF_UI,
+  PROF_PRESENT, // EndDrawing(): batch flush, swap, input poll
+  PROF_PHASES
+} ProfPhase;
+
+// Frames kept for the rolling percentiles
+#define PROF_WINDOW 240
+#define PROF_HISTOGRAM_BINS 34 // 1 ms each, the last one catches the rest
+
+typedef struct {
+  uint64_t start[PROF_PHASES];
+  float current[PROF_PHASES]; // ms spent this frame
+  float samples[PROF_PHASES + 1][PROF_WINDOW]; // Last row is the whole frame
+  uint32_t histogram[PROF_HISTOGRAM_BINS];
+  // Key press to the end of the first EndDrawing() after its tick, ms. Only
+  // frames that applied a press have a sample.
+  float latency[PROF_WINDOW];
+  uint64_t latencyCount;
+  float currentLatency; // < 0 when this frame applied no press
+  uint64_t frameStart;
+  uint64_t frame;
+  FILE *csv;
+  bool overlay;
+} Profiler;
+
+extern Profiler profiler;
+
+uint64_t ProfNow(void); // Nanoseconds, monotonic
+
+// Starts writing one row per frame, returns false if path cannot be opened
+bool ProfOpenCsv(const char *path);
+void ProfClose(void);
+
+void ProfInputLatency(float ms);
+void ProfEndFrame(void);
+void ProfDrawOverlay(void);
+
+#define PROF_BEGIN(phase) (profiler.start[phase] = ProfNow())
+#define PROF_END(phase)                                                        \
+  (profiler.current[phase] += (ProfNow() - profiler.start[phase]) / 1e6f)
+#define PROF_INPUT_LATENCY(ms) ProfInputLatency(ms)
+#define PROF_END_FRAME() ProfEndFrame()
+#define PROF_TOGGLE_OVERLAY() (profiler.overlay = !profiler.overlay)
+#define PROF_DRAW_OVERLAY() ProfDrawOverlay()
+
+#else
+
+#define PROF_BEGIN(phase) ((void)0)
+#define PROF_END(phase) ((void)0)
+#define PROF_INPUT_LATENCY(ms) ((void)0)
+#define PROF_END_FRAME() ((void)0)
+#define PROF_TOGGLE_OVERLAY() ((void)0)
+#define PROF_DRAW_OVERLAY() ((void)0)
+
+#endif
+
+#endif
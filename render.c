@@ -0,0 +1,124 @@
+#include "render.h"
+
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <assert.h>
+
+// Quads handed to rlgl per rlBegin()/rlEnd(), well below its batch size
+#define PARTICLE_CHUNK 1024
+
+#ifdef DEBUG_OVERLAY
+void DrawDebugOverlay(const Entities *entities, const SimBird *bird,
+                      float alpha) {
+  for (int i = 0; i < entities->count; i++) {
+    if (!(entities->flags[i] & ENTITY_TILED)) {
+      continue;
+    }
+    for (float x = entities->x[i]; x < SCREEN_WIDTH; x += entities->width[i]) {
+      DrawRectangleV((Vector2){x, entities->y[i]},
+                     (Vector2){2, SCREEN_HEIGHT}, RED);
+    }
+  }
+
+  float y = Lerp(SimFloat(bird->previousY), SimFloat(bird->y), alpha);
+  DrawCircleV((Vector2){bird->x, y}, 2, WHITE);
+}
+#endif
+
+void DrawParticles(const ParticlePool *pool, Texture2D texture,
+                   const Rectangle *frames, int frameCount, Color tint) {
+  assert(pool != NULL);
+  assert(frames != NULL);
+  assert(frameCount > 0 && frameCount <= PARTICLE_MAX_FRAMES);
+
+  float u0[PARTICLE_MAX_FRAMES], v0[PARTICLE_MAX_FRAMES];
+  float u1[PARTICLE_MAX_FRAMES], v1[PARTICLE_MAX_FRAMES];
+  float halfW[PARTICLE_MAX_FRAMES], halfH[PARTICLE_MAX_FRAMES];
+  for (int f = 0; f < frameCount; f++) {
+    Rectangle r = frames[f];
+    u0[f] = r.x / texture.width;
+    v0[f] = r.y / texture.height;
+    u1[f] = (r.x + r.width) / texture.width;
+    v1[f] = (r.y + r.height) / texture.height;
+    halfW[f] = r.width * SCALE / 2.0f;
+    halfH[f] = r.height * SCALE / 2.0f;
+  }
+
+  rlSetTexture(texture.id);
+  for (int start = 0; start < pool->count; start += PARTICLE_CHUNK) {
+    int end = start + PARTICLE_CHUNK;
+    end = end > pool->count ? pool->count : end;
+
+    rlCheckRenderBatchLimit(4 * (end - start));
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (int i = start; i < end; i++) {
+      int f = pool->frame[i] % frameCount;
+      float fade = pool->life[i] / PARTICLE_FADE;
+      unsigned char alpha = fade < 1.0f ? (unsigned char)(tint.a * fade)
+                                        : tint.a;
+      float x = pool->x[i];
+      float y = pool->y[i];
+
+      rlColor4ub(tint.r, tint.g, tint.b, alpha);
+      rlTexCoord2f(u0[f], v0[f]);
+      rlVertex2f(x - halfW[f], y - halfH[f]);
+      rlTexCoord2f(u0[f], v1[f]);
+      rlVertex2f(x - halfW[f], y + halfH[f]);
+      rlTexCoord2f(u1[f], v1[f]);
+      rlVertex2f(x + halfW[f], y + halfH[f]);
+      rlTexCoord2f(u1[f], v0[f]);
+      rlVertex2f(x + halfW[f], y - halfH[f]);
+    }
+    rlEnd();
+  }
+  rlSetTexture(0);
+}
+
+bool LoadLowResTarget(LowResTarget *lowRes) {
+  assert(lowRes != NULL);
+
+  lowRes->target = LoadRenderTexture(LOW_RES_WIDTH, LOW_RES_HEIGHT);
+  if (!IsRenderTextureValid(lowRes->target)) {
+    return false;
+  }
+  // The upscale is not by a whole number, bilinear keeps the scrolling
+  // from shimmering
+  SetTextureFilter(lowRes->target.texture, TEXTURE_FILTER_BILINEAR);
+  lowRes->camera = (Camera2D){.offset = {0, 0},
+                              .target = {0, 0},
+                              .rotation = 0,
+                              .zoom = 1.0f / SCALE};
+  return true;
+}
+
+void UnloadLowResTarget(LowResTarget *lowRes) {
+  assert(lowRes != NULL);
+
+  UnloadRenderTexture(lowRes->target);
+}
+
+void BeginLowRes(const LowResTarget *lowRes) {
+  assert(lowRes != NULL);
+
+  BeginTextureMode(lowRes->target);
+  ClearBackground(BLACK);
+  BeginMode2D(lowRes->camera);
+}
+
+void EndLowRes(void) {
+  EndMode2D();
+  EndTextureMode();
+}
+
+void DrawLowRes(const LowResTarget *lowRes) {
+  assert(lowRes != NULL);
+
+  // Render textures are stored bottom up, the negative height flips them.
+  // Only the part the camera covers is scaled, so the mapping is exact.
+  Rectangle source = {0, 0, SCREEN_WIDTH / SCALE, -SCREEN_HEIGHT / SCALE};
+  Rectangle dest = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+  DrawTexturePro(lowRes->target.texture, source, dest, (Vector2){0, 0}, 0,
+                 WHITE);
+}
@@ -0,0 +1,55 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+// Drawing of the game world from sim state, shared by the game and the
+// rendered benchmark. Nothing in here changes the simulation. The sprites
+// themselves are entities, see entity.h.
+
+#include "entity.h"
+#include "particle.h"
+#include "raylib.h"
+#include "sim.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef DEBUG_OVERLAY
+// Tile seams of the tiled entities and the bird center, toggled with F1.
+// Only built with make DEBUG=1 so release builds carry none of it.
+void DrawDebugOverlay(const Entities *entities, const SimBird *bird,
+                      float alpha);
+#endif
+
+// Frames a particle pool may pick from
+#define PARTICLE_MAX_FRAMES 8
+
+// Every particle as one quad of frames[frame] under one texture bind, like
+// the ghost batch. tint's alpha fades out over the last PARTICLE_FADE
+// seconds of each particle.
+void DrawParticles(const ParticlePool *pool, Texture2D texture,
+                   const Rectangle *frames, int frameCount, Color tint);
+
+// The art's native resolution, the window is SCALE times larger
+#define LOW_RES_WIDTH ((int)(SCREEN_WIDTH / SCALE + 0.999f))
+#define LOW_RES_HEIGHT ((int)(SCREEN_HEIGHT / SCALE + 0.999f))
+
+// Offscreen target for --low-res. The world is drawn into it at native
+// resolution, a camera zoom maps the sim's screen coordinates onto it, and
+// one quad scales it up to the window. 1/SCALE^2 of the pixels are shaded.
+typedef struct {
+  RenderTexture2D target;
+  Camera2D camera;
+} LowResTarget;
+
+bool LoadLowResTarget(LowResTarget *lowRes);
+void UnloadLowResTarget(LowResTarget *lowRes);
+
+// Everything drawn in between lands in the target, call inside
+// BeginDrawing()
+void BeginLowRes(const LowResTarget *lowRes);
+void EndLowRes(void);
+
+// Scales the target up to the whole window
+void DrawLowRes(const LowResTarget *lowRes);
+
+#endif
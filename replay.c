@@ -0,0 +1,235 @@
+#include "replay.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void ReplayInit(Replay *replay, uint64_t seed, uint32_t flags) {
+  assert(replay != NULL);
+
+  *replay = (Replay){.header = {.magic = REPLAY_MAGIC,
+                                .version = REPLAY_VERSION,
+                                .seed = seed,
+                                .flags = flags | REPLAY_NUMBERS}};
+}
+
+void ReplayFree(Replay *replay) {
+  assert(replay != NULL);
+
+  free(replay->events);
+  replay->events = NULL;
+  replay->size = replay->capacity = 0;
+}
+
+static bool PutByte(Replay *replay, unsigned char byte) {
+  if (replay->size == replay->capacity) {
+    size_t capacity = replay->capacity != 0 ? replay->capacity * 2 : 256;
+    unsigned char *events = realloc(replay->events, capacity);
+    if (events == NULL) {
+      return false;
+    }
+    replay->events = events;
+    replay->capacity = capacity;
+  }
+  replay->events[replay->size++] = byte;
+  return true;
+}
+
+bool ReplayRecord(Replay *replay, uint64_t tick, SimInput input) {
+  assert(replay != NULL);
+  assert(tick >= replay->lastTick);
+
+  unsigned bits = (input.start ? REPLAY_START : 0) |
+                  (input.jump ? REPLAY_JUMP : 0);
+  if (bits == 0) {
+    return true;
+  }
+
+  uint64_t value = (tick - replay->lastTick) << 2 | bits;
+  do {
+    unsigned char byte = value & 0x7F;
+    value >>= 7;
+    if (!PutByte(replay, byte | (value != 0 ? 0x80 : 0))) {
+      return false;
+    }
+  } while (value != 0);
+
+  replay->lastTick = tick;
+  return true;
+}
+
+void ReplayEnd(Replay *replay, const SimState *state) {
+  assert(replay != NULL);
+  assert(state != NULL);
+
+  replay->header.endTick = state->tick;
+  replay->header.score = state->score;
+  replay->header.checksum = SimChecksum(state);
+  replay->header.size = (uint32_t)replay->size;
+}
+
+// The header field by field in little-endian, whatever the host's order
+static unsigned char *PutLE(unsigned char *out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) {
+    out[i] = (unsigned char)(value >> (8 * i));
+  }
+  return out + bytes;
+}
+
+static uint64_t GetLE(const unsigned char **in, int bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; i++) {
+    value |= (uint64_t)(*in)[i] << (8 * i);
+  }
+  *in += bytes;
+  return value;
+}
+
+static void EncodeHeader(const ReplayHeader *header,
+                         unsigned char out[REPLAY_HEADER_SIZE]) {
+  out = PutLE(out, header->magic, 4);
+  out = PutLE(out, header->version, 4);
+  out = PutLE(out, header->seed, 8);
+  out = PutLE(out, header->endTick, 8);
+  out = PutLE(out, header->flags, 4);
+  out = PutLE(out, header->score, 4);
+  out = PutLE(out, header->checksum, 4);
+  PutLE(out, header->size, 4);
+}
+
+static ReplayHeader DecodeHeader(const unsigned char in[REPLAY_HEADER_SIZE]) {
+  ReplayHeader header;
+  header.magic = (uint32_t)GetLE(&in, 4);
+  header.version = (uint32_t)GetLE(&in, 4);
+  header.seed = GetLE(&in, 8);
+  header.endTick = GetLE(&in, 8);
+  header.flags = (uint32_t)GetLE(&in, 4);
+  header.score = (uint32_t)GetLE(&in, 4);
+  header.checksum = (uint32_t)GetLE(&in, 4);
+  header.size = (uint32_t)GetLE(&in, 4);
+  return header;
+}
+
+bool ReplaySave(const Replay *replay, const char *path) {
+  assert(replay != NULL);
+  assert(path != NULL);
+
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return false;
+  }
+
+  unsigned char header[REPLAY_HEADER_SIZE];
+  EncodeHeader(&replay->header, header);
+  bool ok = fwrite(header, sizeof(header), 1, file) == 1 &&
+            fwrite(replay->events, 1, replay->size, file) == replay->size;
+  return fclose(file) == 0 && ok;
+}
+
+// Reads one varint at the cursor, false at the end or on a truncated event
+static bool NextEvent(Replay *replay) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (replay->cursor == replay->size) {
+      return false;
+    }
+    unsigned char byte = replay->events[replay->cursor++];
+    value |= (uint64_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      replay->nextTick = replay->lastTick + (value >> 2);
+      replay->nextBits = value & 3;
+      return replay->nextBits != 0;
+    }
+  }
+  return false;
+}
+
+bool ReplayLoad(Replay *replay, const char *path) {
+  assert(replay != NULL);
+  assert(path != NULL);
+
+  *replay = (Replay){0};
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+
+  unsigned char bytes[REPLAY_HEADER_SIZE];
+  bool ok = fread(bytes, sizeof(bytes), 1, file) == 1;
+  ReplayHeader header = DecodeHeader(bytes);
+  ok = ok && header.magic == REPLAY_MAGIC && header.version == REPLAY_VERSION;
+  unsigned char *events = ok && header.size > 0 ? malloc(header.size) : NULL;
+  if (ok && header.size > 0) {
+    ok = events != NULL && fread(events, 1, header.size, file) == header.size;
+  }
+  fclose(file);
+  if (!ok) {
+    free(events);
+    return false;
+  }
+
+  replay->header = header;
+  replay->events = events;
+  replay->size = replay->capacity = header.size;
+
+  // Every event has to decode and stay within the run
+  while (replay->cursor < replay->size) {
+    if (!NextEvent(replay) || replay->nextTick >= header.endTick) {
+      ReplayFree(replay);
+      return false;
+    }
+    replay->lastTick = replay->nextTick;
+  }
+  ReplayRewind(replay);
+  return true;
+}
+
+void ReplayRewind(Replay *replay) {
+  assert(replay != NULL);
+
+  replay->cursor = 0;
+  replay->lastTick = 0;
+  if (!NextEvent(replay)) {
+    replay->nextBits = 0;
+  }
+}
+
+SimInput ReplayInput(Replay *replay, uint64_t tick) {
+  assert(replay != NULL);
+
+  if (replay->nextBits == 0 || tick != replay->nextTick) {
+    return (SimInput){0};
+  }
+
+  SimInput input = {.start = replay->nextBits & REPLAY_START,
+                    .jump = replay->nextBits & REPLAY_JUMP};
+  replay->lastTick = tick;
+  if (!NextEvent(replay)) {
+    replay->nextBits = 0;
+  }
+  return input;
+}
+
+bool ReplayMatches(const Replay *replay, const SimState *state) {
+  assert(replay != NULL);
+  assert(state != NULL);
+
+  return state->tick == replay->header.endTick &&
+         state->score == replay->header.score &&
+         SimChecksum(state) == replay->header.checksum;
+}
+
+bool ReplayPlay(Replay *replay, const CollisionMasks *masks, SimState *state) {
+  assert(replay != NULL);
+  assert(state != NULL);
+
+  SimInit(state, replay->header.seed);
+  state->masks = masks;
+
+  ReplayRewind(replay);
+  while (state->tick < replay->header.endTick) {
+    SimStep(state, ReplayInput(replay, state->tick));
+  }
+  return ReplayMatches(replay, state);
+}
@@ -0,0 +1,92 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Recorded runs. The sim is deterministic for a seed, so the seed and the
+// tick every input was consumed on are enough to play a run back exactly.
+// The end state's checksum is stored too, so a replay can tell whether it
+// still reproduces the recording. Does not depend on raylib.
+//
+// Layout, all integers little-endian:
+//   ReplayHeader, REPLAY_HEADER_SIZE bytes of its fields in order, unpadded
+//   events, one LEB128 varint each: ticks since the previous event << 2,
+//   REPLAY_START and REPLAY_JUMP in the low bits
+
+#include "sim.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define REPLAY_MAGIC 0x50524C46u // "FLRP"
+#define REPLAY_VERSION 2u // 2: counter-based pipe gaps
+
+// Event bits
+#define REPLAY_START 1u
+#define REPLAY_JUMP 2u
+
+// Header flags, settings that change how the run plays out
+#define REPLAY_PIXEL_COLLISION 1u
+#define REPLAY_FIXED_POINT 2u // Set by ReplayInit() in FIXED_POINT builds
+
+// REPLAY_FIXED_POINT as this build steps the sim, a replay only plays back
+// on a build with the same
+#ifdef SIM_FIXED_POINT
+#define REPLAY_NUMBERS REPLAY_FIXED_POINT
+#else
+#define REPLAY_NUMBERS 0u
+#endif
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t seed;
+  uint64_t endTick; // Ticks stepped when the recording stopped
+  uint32_t flags;
+  uint32_t score;    // At endTick
+  uint32_t checksum; // SimChecksum() at endTick
+  uint32_t size;     // Bytes of events after the header
+} ReplayHeader;
+
+#define REPLAY_HEADER_SIZE 40
+
+typedef struct {
+  ReplayHeader header;
+  unsigned char *events;
+  size_t size;
+  size_t capacity;
+  uint64_t lastTick; // Tick of the last recorded or played event
+
+  // Playback position
+  size_t cursor;
+  uint64_t nextTick;
+  unsigned nextBits; // 0 once every event was played
+} Replay;
+
+// REPLAY_NUMBERS is added to flags
+void ReplayInit(Replay *replay, uint64_t seed, uint32_t flags);
+void ReplayFree(Replay *replay);
+
+// Appends the input consumed on tick, ticks must not go backwards. Empty
+// inputs are not stored. Returns false when out of memory.
+bool ReplayRecord(Replay *replay, uint64_t tick, SimInput input);
+// Stores the end state the replay is checked against
+void ReplayEnd(Replay *replay, const SimState *state);
+
+bool ReplaySave(const Replay *replay, const char *path);
+// Returns false if the file is missing or malformed
+bool ReplayLoad(Replay *replay, const char *path);
+
+// Back to the first event
+void ReplayRewind(Replay *replay);
+// Input for tick, ticks must be asked for in increasing order
+SimInput ReplayInput(Replay *replay, uint64_t tick);
+
+// True when state is the recorded end state
+bool ReplayMatches(const Replay *replay, const SimState *state);
+
+// Steps a fresh state through the whole replay as fast as possible, masks
+// must be set when the header has REPLAY_PIXEL_COLLISION. Returns
+// ReplayMatches().
+bool ReplayPlay(Replay *replay, const CollisionMasks *masks, SimState *state);
+
+#endif
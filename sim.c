@@ -0,0 +1,241 @@
+#include "sim.h"
+#include "collision.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+void SimInit(SimState *state, uint64_t seed) {
+  assert(state != NULL);
+
+  *state = (SimState){.bird = {.x = BIRD_START_X,
+                               .y = SIM_VALUE(BIRD_START_Y),
+                               .previousY = SIM_VALUE(BIRD_START_Y),
+                               .velocityY = 0,
+                               .radius = BIRD_RADIUS,
+                               .angle = 0,
+                               .frame = 0,
+                               .frameTicks = 0},
+                      .masks = NULL,
+                      .started = false,
+                      .dead = false,
+                      .score = 0,
+                      .tick = 0,
+                      .events = 0};
+  PipeRingInit(&state->pipes, seed);
+}
+
+void SimSave(const SimState *state, SimSnapshot *snapshot) {
+  assert(state != NULL);
+  assert(snapshot != NULL);
+
+  memcpy(&snapshot->state, state, sizeof(*state));
+}
+
+void SimRestore(SimState *state, const SimSnapshot *snapshot) {
+  assert(state != NULL);
+  assert(snapshot != NULL);
+
+  memcpy(state, &snapshot->state, sizeof(*state));
+}
+
+#ifdef SIM_FIXED_POINT
+
+static SimValue ClampValue(SimValue value, SimValue min, SimValue max) {
+  SimValue result = value < min ? min : value;
+  return result > max ? max : result;
+}
+
+// The float steps below on 24.8 integers, see fixed.h
+void SimStepBird(SimBird *bird, bool jump) {
+  assert(bird != NULL);
+
+  bird->previousY = bird->y;
+
+  if (jump) {
+    bird->velocityY = SIM_VALUE(JUMP_VELOCITY);
+  }
+
+  bird->velocityY += SIM_VALUE(GRAVITY / SIM_HZ);
+  bird->velocityY =
+      ClampValue(bird->velocityY, SIM_VALUE(FALL_VELOCITY_MIN),
+                 SIM_VALUE(FALL_VELOCITY_MAX));
+
+  bird->y += (bird->velocityY * SIM_FIXED_DT) >> SIM_FIXED_DT_BITS;
+
+  bird->velocityY -= (bird->velocityY * SIM_FIXED_DRAG) >> SIM_FIXED_DRAG_BITS;
+
+  SimValue radius = SimFromFloat(bird->radius * SCALE);
+  if (bird->y > SIM_VALUE(BASE_POS_Y) - radius) {
+    bird->y = SIM_VALUE(BASE_POS_Y) - radius;
+    bird->velocityY = 0;
+  }
+
+  if (bird->y < radius) {
+    bird->y = radius;
+    bird->velocityY = 0;
+  }
+
+  // Change angle only if bird is moving else use old angle
+  if (bird->velocityY != 0) {
+    bird->angle = (bird->velocityY - SIM_VALUE(MIN_VELOCITY)) * 120 /
+                      (MAX_VELOCITY - MIN_VELOCITY) -
+                  SIM_VALUE(30);
+  }
+}
+
+#else
+
+static float ClampFloat(float value, float min, float max) {
+  float result = value < min ? min : value;
+  return result > max ? max : result;
+}
+
+void SimStepBird(SimBird *bird, bool jump) {
+  assert(bird != NULL);
+
+  bird->previousY = bird->y;
+
+  if (jump) {
+    bird->velocityY = JUMP_VELOCITY;
+  }
+
+  bird->velocityY += GRAVITY * SIM_DT;
+  bird->velocityY =
+      ClampFloat(bird->velocityY, FALL_VELOCITY_MIN, FALL_VELOCITY_MAX);
+
+  bird->y += bird->velocityY * SIM_DT;
+
+  bird->velocityY *= VELOCITY_DAMPING;
+
+  if (bird->y > BASE_POS_Y - bird->radius * SCALE) {
+    bird->y = BASE_POS_Y - bird->radius * SCALE;
+    bird->velocityY = 0;
+  }
+
+  if (bird->y < bird->radius * SCALE) {
+    bird->y = bird->radius * SCALE;
+    bird->velocityY = 0;
+  }
+
+  // Change angle only if bird is moving else use old angle
+  if (bird->velocityY != 0) {
+    bird->angle = (bird->velocityY - MIN_VELOCITY) /
+                      (float)(MAX_VELOCITY - MIN_VELOCITY) * 120.0f -
+                  30.0f;
+  }
+}
+
+#endif
+
+void SimAnimateBird(SimBird *bird) {
+  assert(bird != NULL);
+
+  if (++bird->frameTicks >= BIRD_FRAME_TICKS) {
+    bird->frameTicks = 0;
+    bird->frame = (bird->frame + 1) % BIRD_FRAMES;
+  }
+}
+
+bool SimBirdHitsPipes(const SimBird *bird, const PipeRing *pipes,
+                      const CollisionMasks *masks) {
+  assert(bird != NULL);
+  assert(pipes != NULL);
+
+  // The masks cover the rotated sprite, which is wider than the circle
+  float extent = masks != NULL ? MASK_BIRD_EXTENT : bird->radius * SCALE;
+  const Pipe *near[COLLISION_MAX_PIPES];
+  float y = SimFloat(bird->y);
+  int count =
+      PipeRingOverlapping(pipes, bird->x - extent, bird->x + extent, near);
+  for (int i = 0; i < count; i++) {
+    if (masks == NULL) {
+      if (CircleHitsPipe(near[i], bird->x, y, extent)) {
+        return true;
+      }
+    } else if ((y - extent < PipeGapTop(near[i]) ||
+                y + extent > PipeGapBottom(near[i])) &&
+               MaskBirdHitsPipe(masks, bird->frame, SimFloat(bird->angle),
+                                bird->x, y, near[i])) {
+      // Box overlaps one of the pipes, only then look at the pixels
+      return true;
+    }
+  }
+  return false;
+}
+
+void SimStep(SimState *state, SimInput input) {
+  assert(state != NULL);
+
+  state->events = 0;
+  if (input.start && !state->started) {
+    state->started = true;
+    state->events |= SIM_EVENT_START;
+  }
+
+  if (!state->dead) {
+    SimAnimateBird(&state->bird);
+  }
+
+  if (state->started && !state->dead) {
+    SimStepBird(&state->bird, input.jump);
+    PipeRingStep(&state->pipes);
+    state->events |= input.jump ? SIM_EVENT_JUMP : 0;
+
+    if (SimBirdHitsPipes(&state->bird, &state->pipes, state->masks)) {
+      state->dead = true;
+      state->events |= SIM_EVENT_DEATH;
+    } else if (PipeRingPassed(&state->pipes, state->bird.x)) {
+      state->score++;
+      state->events |= SIM_EVENT_SCORE;
+    }
+  } else {
+    state->bird.previousY = state->bird.y;
+  }
+
+  state->tick++;
+}
+
+static uint32_t HashBytes(uint32_t hash, const void *data, size_t size) {
+  const unsigned char *bytes = data;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static uint32_t HashFloat(uint32_t hash, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return HashBytes(hash, &bits, sizeof(bits));
+}
+
+static uint32_t HashValue(uint32_t hash, SimValue value) {
+  return HashBytes(hash, &value, sizeof(value));
+}
+
+uint32_t SimChecksum(const SimState *state) {
+  assert(state != NULL);
+
+  // Field by field, padding bytes are not part of the state
+  const SimBird *bird = &state->bird;
+  uint32_t hash = 2166136261u;
+  hash = HashValue(hash, bird->y);
+  hash = HashValue(hash, bird->previousY);
+  hash = HashValue(hash, bird->velocityY);
+  hash = HashValue(hash, bird->angle);
+  hash = HashBytes(hash, &bird->frame, sizeof(bird->frame));
+  hash = HashBytes(hash, &bird->frameTicks, sizeof(bird->frameTicks));
+
+  for (int i = 0; i < PIPE_COUNT; i++) {
+    const Pipe *pipe = PipeRingGet(&state->pipes, i);
+    hash = HashFloat(hash, pipe->x);
+    hash = HashFloat(hash, pipe->gapY);
+  }
+
+  uint8_t flags = (uint8_t)(state->started | state->dead << 1);
+  hash = HashBytes(hash, &flags, sizeof(flags));
+  hash = HashBytes(hash, &state->score, sizeof(state->score));
+  hash = HashBytes(hash, &state->tick, sizeof(state->tick));
+  return hash;
+}
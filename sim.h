@@ -0,0 +1,81 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Headless game simulation. Nothing in here depends on raylib, a window or a
+// GPU, so it can be stepped on servers as fast as the CPU allows.
+
+#include "config.h"
+#include "fixed.h"
+#include "mask.h"
+#include "pipes.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The SimValue fields are read with SimFloat(), see fixed.h
+typedef struct {
+  float x;    // Center of the bird, in screen pixels
+  SimValue y;
+  SimValue previousY; // y at the previous tick, used for render interpolation
+  SimValue velocityY;
+  float radius;   // Unscaled, multiply by SCALE for screen pixels
+  SimValue angle; // Degrees, kept while the bird is not moving
+  int frame;
+  int frameTicks;
+} SimBird;
+
+// SimState.events bits
+#define SIM_EVENT_START 1u
+#define SIM_EVENT_JUMP 2u
+#define SIM_EVENT_SCORE 4u
+#define SIM_EVENT_DEATH 8u
+
+typedef struct {
+  SimBird bird;
+  PipeRing pipes;
+  // Pixel-accurate collision when set, circle vs rectangle when NULL. Not
+  // owned, the masks outlive the state.
+  const CollisionMasks *masks;
+  bool started;
+  bool dead; // Hit a pipe, the world stops until SimInit() or SimRestore()
+  uint32_t score; // Pipes passed
+  uint64_t tick;
+  uint32_t events; // SIM_EVENT_* bits of the last tick, for sound and stats
+} SimState;
+
+typedef struct {
+  bool start;
+  bool jump;
+} SimInput;
+
+// A whole run by value. SimState is plain data with no pointer into itself,
+// and the pipe RNG is just the seed and the pipe counter in PipeRing, so
+// saving or restoring is one memcpy. masks is carried along, it points at
+// shared read-only data.
+typedef struct {
+  SimState state;
+} SimSnapshot;
+
+// seed picks the pipe layout
+void SimInit(SimState *state, uint64_t seed);
+void SimStep(SimState *state, SimInput input);
+
+// Restart, rewind, or fork a copy to search ahead from
+void SimSave(const SimState *state, SimSnapshot *snapshot);
+void SimRestore(SimState *state, const SimSnapshot *snapshot);
+
+// Bird integration only, shared by every caller that moves a bird
+void SimStepBird(SimBird *bird, bool jump);
+
+// Advances the flap animation by one tick
+void SimAnimateBird(SimBird *bird);
+
+// masks may be NULL, see SimState
+bool SimBirdHitsPipes(const SimBird *bird, const PipeRing *pipes,
+                      const CollisionMasks *masks);
+
+// FNV-1a over everything SimStep() changes, two states that hash the same
+// are the same run
+uint32_t SimChecksum(const SimState *state);
+
+#endif
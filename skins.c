@@ -0,0 +1,257 @@
+#include "skins.h"
+#include "assets.h"
+
+#include "rlgl.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+static const char *skinNames[SKIN_COUNT] = {
+    [SKIN_BLUE] = "blue",
+    [SKIN_RED] = "red",
+    [SKIN_YELLOW] = "yellow",
+};
+
+// Flap frames of every skin, in SimBird.frame order
+static const Sprite skinFrames[SKIN_COUNT][BIRD_FRAMES] = {
+    [SKIN_BLUE] = {SPRITE_BLUEBIRD_UPFLAP, SPRITE_BLUEBIRD_MIDFLAP,
+                   SPRITE_BLUEBIRD_DOWNFLAP},
+    [SKIN_RED] = {SPRITE_REDBIRD_UPFLAP, SPRITE_REDBIRD_MIDFLAP,
+                  SPRITE_REDBIRD_DOWNFLAP},
+    [SKIN_YELLOW] = {SPRITE_YELLOWBIRD_UPFLAP, SPRITE_YELLOWBIRD_MIDFLAP,
+                     SPRITE_YELLOWBIRD_DOWNFLAP},
+};
+
+// texelFetch() only, so no filtering ever blends two indices. The skin and
+// the opacity come in the vertex color, see SkinTint().
+static const char *paletteShader =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform sampler2D palettes;\n"
+    "out vec4 finalColor;\n"
+    "void main() {\n"
+    "  ivec2 size = textureSize(texture0, 0);\n"
+    "  ivec2 texel = ivec2(fragTexCoord * vec2(size));\n"
+    "  int index = int(texelFetch(texture0, texel, 0).r * 255.0 + 0.5);\n"
+    "  int skin = int(fragColor.r * 255.0 + 0.5);\n"
+    "  vec4 color = texelFetch(palettes, ivec2(index, skin), 0);\n"
+    "  finalColor = vec4(color.rgb, color.a * fragColor.a);\n"
+    "}\n";
+
+const char *SkinName(Skin skin) {
+  assert(skin >= 0 && skin < SKIN_COUNT);
+  return skinNames[skin];
+}
+
+int SkinFind(const char *name) {
+  assert(name != NULL);
+
+  for (int i = 0; i < SKIN_COUNT; i++) {
+    if (strcmp(skinNames[i], name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static bool SameColor(const unsigned char *a, Color b) {
+  return a[0] == b.r && a[1] == b.g && a[2] == b.b && a[3] == b.a;
+}
+
+bool BuildSkinImages(const Image *images, Rectangle *rects, Image *indices,
+                     Image *palettes) {
+  assert(images != NULL);
+  assert(rects != NULL);
+  assert(indices != NULL);
+  assert(palettes != NULL);
+
+  // Frames side by side, with the same empty border as atlas sprites
+  int width = 0;
+  int height = 0;
+  for (int f = 0; f < BIRD_FRAMES; f++) {
+    const Image *frame = &images[skinFrames[SKIN_BLUE][f]];
+    rects[f] = (Rectangle){width + ATLAS_PADDING, ATLAS_PADDING, frame->width,
+                           frame->height};
+    width += frame->width + ATLAS_PADDING * 2;
+    height = frame->height > height ? frame->height : height;
+  }
+  height += ATLAS_PADDING * 2;
+
+  Color colors[SKIN_COUNT][SKIN_PALETTE_SIZE] = {0}; // Index 0 stays BLANK
+  bool known[SKIN_COUNT][SKIN_PALETTE_SIZE] = {0};
+  int count = 1;
+
+  *indices = GenImageColor(width, height, BLANK);
+  ImageFormat(indices, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+  unsigned char *out = indices->data;
+  for (int f = 0; f < BIRD_FRAMES; f++) {
+    const Image *blue = &images[skinFrames[SKIN_BLUE][f]];
+    for (int s = 0; s < SKIN_COUNT; s++) {
+      const Image *frame = &images[skinFrames[s][f]];
+      assert(frame->format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+      if (frame->width != blue->width || frame->height != blue->height) {
+        TraceLog(LOG_ERROR, "%s is not the size of %s",
+                 AtlasSpriteName(skinFrames[s][f]),
+                 AtlasSpriteName(skinFrames[SKIN_BLUE][f]));
+        UnloadImage(*indices);
+        return false;
+      }
+    }
+
+    for (int p = 0; p < blue->width * blue->height; p++) {
+      const unsigned char *pixel = (const unsigned char *)blue->data + p * 4;
+      int index = 0;
+      if (pixel[3] != 0) {
+        for (index = 1; index < count; index++) {
+          if (SameColor(pixel, colors[SKIN_BLUE][index])) {
+            break;
+          }
+        }
+        if (index == SKIN_PALETTE_SIZE) {
+          TraceLog(LOG_ERROR, "Bird frames have more than %d colors",
+                   SKIN_PALETTE_SIZE - 1);
+          UnloadImage(*indices);
+          return false;
+        }
+        count = index == count ? count + 1 : count;
+      }
+
+      // Every skin has to agree on what this index is
+      for (int s = 0; s < SKIN_COUNT; s++) {
+        const unsigned char *other =
+            (const unsigned char *)images[skinFrames[s][f]].data + p * 4;
+        if (!known[s][index] && index != 0) {
+          colors[s][index] =
+              (Color){other[0], other[1], other[2], other[3]};
+          known[s][index] = true;
+        }
+        bool same = index == 0 ? other[3] == 0
+                               : SameColor(other, colors[s][index]);
+        if (!same) {
+          TraceLog(LOG_ERROR, "%s does not recolor %s pixel for pixel",
+                   AtlasSpriteName(skinFrames[s][f]),
+                   AtlasSpriteName(skinFrames[SKIN_BLUE][f]));
+          UnloadImage(*indices);
+          return false;
+        }
+      }
+
+      int x = (int)rects[f].x + p % blue->width;
+      int y = (int)rects[f].y + p / blue->width;
+      out[y * width + x] = (unsigned char)index;
+    }
+  }
+
+  *palettes = GenImageColor(SKIN_PALETTE_SIZE, SKIN_COUNT, BLANK);
+  memcpy(palettes->data, colors, sizeof(colors));
+  TraceLog(LOG_INFO, "Built %d bird skins from %d colors", SKIN_COUNT,
+           count - 1);
+  return true;
+}
+
+// RGBA8 of one skin, laid out like indices
+static Image ExpandSkin(Image indices, Image palettes, Skin skin) {
+  Image image = GenImageColor(indices.width, indices.height, BLANK);
+  const unsigned char *in = indices.data;
+  const Color *row = (const Color *)palettes.data + skin * SKIN_PALETTE_SIZE;
+  Color *out = image.data;
+  for (int i = 0; i < indices.width * indices.height; i++) {
+    out[i] = row[in[i] < SKIN_PALETTE_SIZE ? in[i] : 0];
+  }
+  return image;
+}
+
+// Uploads both images, which stay owned by the caller
+static bool Upload(BirdSkins *skins, Image indices, Image palettes,
+                   Image *image) {
+  skins->indices = LoadTextureFromImage(indices);
+  skins->palettes = LoadTextureFromImage(palettes);
+  if (!IsTextureValid(skins->indices) || !IsTextureValid(skins->palettes)) {
+    TraceLog(LOG_ERROR, "Failed to upload the bird skins");
+    UnloadTexture(skins->indices);
+    UnloadTexture(skins->palettes);
+    return false;
+  }
+
+  // raylib falls back to its default shader when compiling fails
+  skins->shader = LoadShaderFromMemory(NULL, paletteShader);
+  if (!IsShaderValid(skins->shader) ||
+      skins->shader.id == rlGetShaderIdDefault()) {
+    TraceLog(LOG_ERROR, "Failed to compile the bird palette shader");
+    UnloadTexture(skins->indices);
+    UnloadTexture(skins->palettes);
+    return false;
+  }
+  skins->palettesLoc = GetShaderLocation(skins->shader, "palettes");
+
+  if (image != NULL) {
+    *image = ExpandSkin(indices, palettes, SKIN_BLUE);
+  }
+  return true;
+}
+
+bool LoadSkinsFromImages(BirdSkins *skins, const Image *images, Image *image) {
+  assert(skins != NULL);
+  assert(images != NULL);
+
+  Image indices;
+  Image palettes;
+  if (!BuildSkinImages(images, skins->rects, &indices, &palettes)) {
+    return false;
+  }
+  bool ok = Upload(skins, indices, palettes, image);
+  UnloadImage(indices);
+  UnloadImage(palettes);
+  return ok;
+}
+
+bool LoadSkinsFromPack(BirdSkins *skins, const Pack *pack, Image *image) {
+  assert(skins != NULL);
+  assert(pack != NULL);
+
+  Image indices;
+  Image palettes;
+  const PackEntry *rects = PackFind(pack, SKIN_RECTS_ENTRY, PACK_DATA);
+  if (!PackImage(pack, SKIN_INDICES_ENTRY, &indices) ||
+      !PackImage(pack, SKIN_PALETTES_ENTRY, &palettes) || rects == NULL ||
+      rects->size != sizeof(skins->rects) ||
+      indices.format != PIXELFORMAT_UNCOMPRESSED_GRAYSCALE ||
+      palettes.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 ||
+      palettes.width != SKIN_PALETTE_SIZE || palettes.height != SKIN_COUNT) {
+    TraceLog(LOG_ERROR, "Asset pack has no usable bird skins");
+    return false;
+  }
+  memcpy(skins->rects, PackData(pack, rects), sizeof(skins->rects));
+
+  // Straight from the mapped pages
+  return Upload(skins, indices, palettes, image);
+}
+
+void UnloadSkins(BirdSkins *skins) {
+  assert(skins != NULL);
+
+  UnloadShader(skins->shader);
+  UnloadTexture(skins->palettes);
+  UnloadTexture(skins->indices);
+}
+
+void BeginSkins(const BirdSkins *skins) {
+  assert(skins != NULL);
+
+  BeginShaderMode(skins->shader);
+  BindSkinPalettes(skins);
+}
+
+void BindSkinPalettes(const BirdSkins *skins) {
+  assert(skins != NULL);
+
+  // rlgl binds the sampler for the next batch draw only and forgets it
+  // after, a flush raylib triggers itself keeps working because nothing
+  // else ever binds texture unit 1
+  SetShaderValueTexture(skins->shader, skins->palettesLoc, skins->palettes);
+}
+
+void EndSkins(void) { EndShaderMode(); }
@@ -0,0 +1,69 @@
+#ifndef SKINS_H
+#define SKINS_H
+
+// Bird colors. The blue, red and yellow birds have the same shapes and only
+// swap colors, so one set of frames is kept as palette indices and a
+// fragment shader looks every pixel up in the palette row of its skin. The
+// skin travels in the red channel of the vertex color, so birds of every
+// skin still share one batch, and a new skin is one more palette row
+// instead of three more frames.
+
+#include "atlas.h"
+#include "config.h"
+#include "pack.h"
+#include "raylib.h"
+
+#include <stdbool.h>
+
+typedef enum { SKIN_BLUE, SKIN_RED, SKIN_YELLOW, SKIN_COUNT } Skin;
+
+// Colors per palette row, index 0 is transparent
+#define SKIN_PALETTE_SIZE 16
+
+typedef struct {
+  Texture2D indices;  // Every frame side by side, one palette index per pixel
+  Texture2D palettes; // SKIN_PALETTE_SIZE x SKIN_COUNT, one row per skin
+  Rectangle rects[BIRD_FRAMES]; // Of each frame in indices
+  Shader shader;
+  int palettesLoc;
+} BirdSkins;
+
+// Builds the index and palette images from the decoded bird sprites, images
+// is indexed by Sprite and RGBA8 and stays owned by the caller. indices is
+// grayscale and palettes RGBA8, the caller unloads both. Fails if a skin
+// does not recolor the blue frames pixel for pixel or they need more than
+// SKIN_PALETTE_SIZE colors.
+bool BuildSkinImages(const Image *images, Rectangle *rects, Image *indices,
+                     Image *palettes);
+
+// Uploads both and compiles the shader. When image is not NULL it receives
+// the frames in SKIN_BLUE as RGBA8, laid out like indices, e.g. for the
+// collision masks. The caller unloads it.
+bool LoadSkinsFromImages(BirdSkins *skins, const Image *images, Image *image);
+// Same, from the pack entries the packer wrote
+bool LoadSkinsFromPack(BirdSkins *skins, const Pack *pack, Image *image);
+void UnloadSkins(BirdSkins *skins);
+
+// Birds are drawn from skins->indices in between, with SkinTint() as the
+// vertex color
+void BeginSkins(const BirdSkins *skins);
+void EndSkins(void);
+// Hands the palettes to rlgl again, after every flush of the render batch
+// between BeginSkins() and EndSkins() that the caller forces
+void BindSkinPalettes(const BirdSkins *skins);
+
+static inline Color SkinTint(Skin skin, unsigned char alpha) {
+  return (Color){(unsigned char)skin, 0, 0, alpha};
+}
+
+// "blue", "red" or "yellow"
+const char *SkinName(Skin skin);
+// Skin with that name, or -1
+int SkinFind(const char *name);
+
+// Pack entries written by the packer
+#define SKIN_INDICES_ENTRY "skin-indices"
+#define SKIN_PALETTES_ENTRY "skin-palettes"
+#define SKIN_RECTS_ENTRY "skin-rects"
+
+#endif
@@ -0,0 +1,234 @@
+#include "telemetry.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+
+// Records the writer formats per write
+#define TELEMETRY_BATCH 64
+// How long the writer sleeps when the ring is empty
+#define TELEMETRY_IDLE_NS 20000000L
+
+static double Now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// One NDJSON line, returns its length
+static int Format(const TelemetryRecord *record, char *out, size_t size) {
+  switch (record->kind) {
+  case TELEMETRY_SESSION_START:
+    return snprintf(out, size,
+                    "{\"type\":\"session_start\",\"t\":%.3f,\"unix\":%lld,"
+                    "\"seed\":%llu}\n",
+                    record->time, (long long)record->session.unixTime,
+                    (unsigned long long)record->session.seed);
+  case TELEMETRY_RUN:
+    return snprintf(out, size,
+                    "{\"type\":\"run\",\"t\":%.3f,\"score\":%u,\"ticks\":%llu,"
+                    "\"jumps\":%u,\"died\":%s}\n",
+                    record->time, record->run.score,
+                    (unsigned long long)record->run.ticks, record->run.jumps,
+                    record->run.died ? "true" : "false");
+  case TELEMETRY_FRAMES:
+    return snprintf(out, size,
+                    "{\"type\":\"frames\",\"t\":%.3f,\"frames\":%u,"
+                    "\"p50_ms\":%.2f,\"p95_ms\":%.2f,\"p99_ms\":%.2f,"
+                    "\"max_ms\":%.2f}\n",
+                    record->time, record->frames.frames, record->frames.p50,
+                    record->frames.p95, record->frames.p99,
+                    record->frames.max);
+  }
+  return 0;
+}
+
+// Formats and writes everything in the ring, returns whether there was any
+static bool Drain(Telemetry *telemetry) {
+  char buffer[TELEMETRY_BATCH * 256]; // Lines are well below 256 bytes
+
+  uint_fast32_t tail =
+      atomic_load_explicit(&telemetry->tail, memory_order_relaxed);
+  uint_fast32_t head =
+      atomic_load_explicit(&telemetry->head, memory_order_acquire);
+  if (tail == head) {
+    return false;
+  }
+
+  while (tail != head) {
+    size_t length = 0;
+    for (int i = 0; i < TELEMETRY_BATCH && tail != head; i++, tail++) {
+      const TelemetryRecord *record =
+          &telemetry->ring[tail % TELEMETRY_RING];
+      length += Format(record, buffer + length, sizeof(buffer) - length);
+    }
+    // The slots are free again once formatted
+    atomic_store_explicit(&telemetry->tail, tail, memory_order_release);
+    fwrite(buffer, 1, length, telemetry->file);
+  }
+  fflush(telemetry->file);
+  return true;
+}
+
+static void *Writer(void *arg) {
+  Telemetry *telemetry = arg;
+
+  while (!atomic_load(&telemetry->stop)) {
+    if (!Drain(telemetry)) {
+      struct timespec idle = {0, TELEMETRY_IDLE_NS};
+      nanosleep(&idle, NULL);
+    }
+  }
+  Drain(telemetry); // What was pushed before the stop
+  return NULL;
+}
+
+bool TelemetryOpen(Telemetry *telemetry, const char *path, uint64_t seed) {
+  assert(telemetry != NULL);
+  assert(path != NULL);
+
+  memset(telemetry, 0, sizeof(*telemetry));
+  telemetry->file = fopen(path, "a");
+  if (telemetry->file == NULL) {
+    return false;
+  }
+  telemetry->start = Now();
+  atomic_init(&telemetry->stop, false);
+  atomic_init(&telemetry->head, 0);
+  atomic_init(&telemetry->tail, 0);
+
+  TelemetryRecord record = {.kind = TELEMETRY_SESSION_START,
+                            .session = {.unixTime = (int64_t)time(NULL),
+                                        .seed = seed}};
+  TelemetryPush(telemetry, &record);
+
+  if (pthread_create(&telemetry->writer, NULL, Writer, telemetry) != 0) {
+    fclose(telemetry->file);
+    return false;
+  }
+  return true;
+}
+
+bool TelemetryPush(Telemetry *telemetry, const TelemetryRecord *record) {
+  assert(telemetry != NULL);
+  assert(record != NULL);
+
+  uint_fast32_t head =
+      atomic_load_explicit(&telemetry->head, memory_order_relaxed);
+  uint_fast32_t tail =
+      atomic_load_explicit(&telemetry->tail, memory_order_acquire);
+  if (head - tail == TELEMETRY_RING) {
+    telemetry->dropped++;
+    return false;
+  }
+
+  TelemetryRecord *slot = &telemetry->ring[head % TELEMETRY_RING];
+  *slot = *record;
+  slot->time = Now() - telemetry->start;
+  atomic_store_explicit(&telemetry->head, head + 1, memory_order_release);
+  return true;
+}
+
+// The run so far, from what TelemetryTick() last saw
+static void PushRun(Telemetry *telemetry, bool died) {
+  TelemetryRecord record = {
+      .kind = TELEMETRY_RUN,
+      .run = {.ticks = telemetry->lastTick - telemetry->startTick,
+              .score = telemetry->score,
+              .jumps = telemetry->jumps,
+              .died = died}};
+  TelemetryPush(telemetry, &record);
+  telemetry->runs++;
+  if (telemetry->score > telemetry->best) {
+    telemetry->best = telemetry->score;
+  }
+  telemetry->inRun = false;
+}
+
+void TelemetryTick(Telemetry *telemetry, const SimState *sim) {
+  assert(telemetry != NULL);
+  assert(sim != NULL);
+
+  if (sim->events & SIM_EVENT_START) {
+    // A restart before the death abandons the run, it is logged anyway
+    if (telemetry->inRun) {
+      PushRun(telemetry, false);
+    }
+    telemetry->inRun = true;
+    telemetry->jumps = 0;
+    // Ticks on the title screen or before a restored snapshot are not the
+    // run's, the start tick itself is
+    telemetry->startTick = sim->tick - 1;
+  }
+  if (!telemetry->inRun) {
+    return;
+  }
+  telemetry->lastTick = sim->tick;
+  telemetry->score = sim->score;
+  if (sim->events & SIM_EVENT_JUMP) {
+    telemetry->jumps++;
+  }
+  if (sim->events & SIM_EVENT_DEATH) {
+    PushRun(telemetry, true);
+  }
+}
+
+// Upper edge of the bucket holding the given share of the window's frames,
+// never above the slowest frame
+static float Percentile(const Telemetry *telemetry, float share) {
+  uint32_t rank = (uint32_t)(telemetry->frames * share);
+  uint32_t seen = 0;
+  for (int i = 0; i < TELEMETRY_BUCKETS - 1; i++) {
+    seen += telemetry->histogram[i];
+    if (seen > rank) {
+      float edge = (i + 1) * TELEMETRY_BUCKET_MS;
+      return edge < telemetry->maxFrame ? edge : telemetry->maxFrame;
+    }
+  }
+  return telemetry->maxFrame;
+}
+
+void TelemetryFrame(Telemetry *telemetry, float dt) {
+  assert(telemetry != NULL);
+
+  // A histogram instead of a sort, so every frame costs the same
+  float ms = dt * 1000.0f;
+  int bucket = (int)(ms / TELEMETRY_BUCKET_MS);
+  bucket = bucket < TELEMETRY_BUCKETS ? bucket : TELEMETRY_BUCKETS - 1;
+  telemetry->histogram[bucket < 0 ? 0 : bucket]++;
+  telemetry->maxFrame = ms > telemetry->maxFrame ? ms : telemetry->maxFrame;
+  if (++telemetry->frames < TELEMETRY_FRAME_WINDOW) {
+    return;
+  }
+
+  TelemetryRecord record = {.kind = TELEMETRY_FRAMES,
+                            .frames = {.frames = telemetry->frames,
+                                       .p50 = Percentile(telemetry, 0.50f),
+                                       .p95 = Percentile(telemetry, 0.95f),
+                                       .p99 = Percentile(telemetry, 0.99f),
+                                       .max = telemetry->maxFrame}};
+  TelemetryPush(telemetry, &record);
+  memset(telemetry->histogram, 0, sizeof(telemetry->histogram));
+  telemetry->frames = 0;
+  telemetry->maxFrame = 0;
+}
+
+void TelemetryClose(Telemetry *telemetry, uint64_t inputDropped) {
+  assert(telemetry != NULL);
+
+  if (telemetry->inRun) {
+    PushRun(telemetry, false);
+  }
+  atomic_store(&telemetry->stop, true);
+  pthread_join(telemetry->writer, NULL);
+
+  // The writer is gone, so this one cannot be dropped
+  fprintf(telemetry->file,
+          "{\"type\":\"session_end\",\"t\":%.3f,\"runs\":%u,\"best\":%u,"
+          "\"input_dropped\":%llu,\"telemetry_dropped\":%llu}\n",
+          Now() - telemetry->start, telemetry->runs, telemetry->best,
+          (unsigned long long)inputDropped,
+          (unsigned long long)telemetry->dropped);
+  fclose(telemetry->file);
+}
@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// Session stats for --telemetry, one JSON object per line appended to a file.
+// The game thread never touches the file: it pushes fixed size records into
+// a single producer, single consumer ring and a writer thread formats and
+// writes them in batches. A full ring drops the record and counts it rather
+// than waiting. Does not depend on raylib.
+//
+// Records, t is seconds since TelemetryOpen():
+//   {"type":"session_start","t":0,"unix":...,"seed":...}
+//   {"type":"run","t":...,"score":...,"ticks":...,"jumps":...,"died":...}
+//   {"type":"frames","t":...,"frames":...,"p50_ms":...,"p95_ms":...,
+//    "p99_ms":...,"max_ms":...}
+//   {"type":"session_end","t":...,"runs":...,"best":...,
+//    "input_dropped":...,"telemetry_dropped":...}
+
+#include "sim.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Records the ring holds, a power of two
+#define TELEMETRY_RING 256
+// Frames per frame time record
+#define TELEMETRY_FRAME_WINDOW 600
+// Frame time histogram for the percentiles, the last bucket takes the rest
+#define TELEMETRY_BUCKET_MS 0.25f
+#define TELEMETRY_BUCKETS 256
+
+typedef enum {
+  TELEMETRY_SESSION_START,
+  TELEMETRY_RUN,
+  TELEMETRY_FRAMES,
+} TelemetryKind;
+
+typedef struct {
+  TelemetryKind kind;
+  double time;
+  union {
+    struct {
+      int64_t unixTime;
+      uint64_t seed;
+    } session;
+    struct {
+      uint64_t ticks;
+      uint32_t score;
+      uint32_t jumps;
+      bool died; // false if the session or the run ended before a death
+    } run;
+    struct {
+      uint32_t frames;
+      float p50, p95, p99, max; // Milliseconds
+    } frames;
+  };
+} TelemetryRecord;
+
+typedef struct {
+  FILE *file;
+  pthread_t writer;
+  atomic_bool stop;
+  double start; // Monotonic seconds at TelemetryOpen()
+
+  TelemetryRecord ring[TELEMETRY_RING];
+  // Written by one side each, on their own cache lines
+  _Alignas(64) atomic_uint_fast32_t head; // Next slot the game thread fills
+  _Alignas(64) atomic_uint_fast32_t tail; // Next slot the writer reads
+
+  // Game thread only from here on
+  _Alignas(64) uint64_t dropped;
+  uint32_t runs;
+  uint32_t best;
+  uint32_t jumps; // In the current run
+  bool inRun;
+  // Current run: sim tick before its start tick, and the latest tick and
+  // score TelemetryTick() saw
+  uint64_t startTick;
+  uint64_t lastTick;
+  uint32_t score;
+  uint16_t histogram[TELEMETRY_BUCKETS];
+  uint32_t frames;
+  float maxFrame;
+} Telemetry;
+
+// Appends to path and starts the writer thread. Nothing is left open on
+// failure.
+bool TelemetryOpen(Telemetry *telemetry, const char *path, uint64_t seed);
+
+// Stops the writer once it drained the ring and writes session_end itself.
+// inputDropped is InputQueue.dropped. A run still going is logged as not
+// died.
+void TelemetryClose(Telemetry *telemetry, uint64_t inputDropped);
+
+// Never blocks. Returns false and counts the record if the ring is full.
+bool TelemetryPush(Telemetry *telemetry, const TelemetryRecord *record);
+
+// After every SimStep(), logs a run when the bird dies or a new one starts
+// before that
+void TelemetryTick(Telemetry *telemetry, const SimState *sim);
+// Once per frame, dt in seconds. Every TELEMETRY_FRAME_WINDOW frames the
+// percentiles are logged.
+void TelemetryFrame(Telemetry *telemetry, float dt);
+
+#endif